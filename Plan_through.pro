@@ -13,21 +13,59 @@ CONFIG += c++17
 SOURCES += appdatas.cpp \
     main.cpp \
     mainwindow.cpp \
+    utils/categoryregistry.cpp \
     utils/datehelper.cpp \
+    utils/dayrecord.cpp \
+    utils/daytemplatestore.cpp \
+    utils/saveworker.cpp \
+    utils/snapshotstore.cpp \
+    utils/streakindex.cpp \
+    utils/studycodec.cpp \
+    utils/studycolumns.cpp \
+    utils/studyrollups.cpp \
+    utils/studystore.cpp \
+    utils/studyjournal.cpp \
+    utils/studyjsonreader.cpp \
+    utils/studylogstore.cpp \
+    utils/tracer.cpp \
     utils/widgetcontainer.cpp \
+    widgets/calendarheatmap.cpp \
+    widgets/categorydialog.cpp \
     widgets/dayview.cpp \
     widgets/monthview.cpp \
+    widgets/slotpicker.cpp \
+    widgets/statsview.cpp \
     widgets/timeaxis.cpp \
+    widgets/yearview.cpp \
     windowservice/service.cpp
 
 HEADERS += appdatas.h \
     datastruct.h \
     mainwindow.h \
+    utils/categoryregistry.h \
     utils/datehelper.h \
+    utils/dayrecord.h \
+    utils/daytemplatestore.h \
+    utils/saveworker.h \
+    utils/snapshotstore.h \
+    utils/streakindex.h \
+    utils/studycodec.h \
+    utils/studycolumns.h \
+    utils/studyrollups.h \
+    utils/studystore.h \
+    utils/studyjournal.h \
+    utils/studyjsonreader.h \
+    utils/studylogstore.h \
+    utils/tracer.h \
     utils/widgetcontainer.h \
+    widgets/calendarheatmap.h \
+    widgets/categorydialog.h \
     widgets/dayview.h \
     widgets/monthview.h \
+    widgets/slotpicker.h \
+    widgets/statsview.h \
     widgets/timeaxis.h \
+    widgets/yearview.h \
     windowservice/service.h
 
 FORMS += \
@@ -1,9 +1,14 @@
 #include "appdatas.h"
+#include "utils/studycodec.h"
+#include "utils/studylogstore.h"
+#include "utils/tracer.h"
+#include <QFileInfo>
 
 AppDatas appDatas;
 
 // 构造函数，初始化应用数据管理
 AppDatas::AppDatas() {
+    TraceScope trace("AppDatas::AppDatas");
     m_appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/Plan_through";
     m_appSettings = new QSettings(m_appDataPath + "/app_settings.ini", QSettings::IniFormat);
 
@@ -11,17 +16,41 @@ AppDatas::AppDatas() {
     initConfigFile();
     initSettings();
 
-    cleanupOldLogs();
-
+    // 解码存档时按类型属性计算学习时长，类型需要先于存档加载
+    {
+        TraceScope traceCategories("CategoryRegistry::load");
+        m_categories.load(m_categoryFilePath);
+    }
     loadDataFromFile();
+    {
+        TraceScope traceTotals("AppDatas::recomputeTotals");
+        recomputeTotals();
+    }
+    // 预写日志重放时增量更新
+    rebuildStreaks();
+    // 设置该环境变量后每次读取统计都与全量扫描比对
+    m_validateTotals = qEnvironmentVariableIsSet("PLAN_THROUGH_VALIDATE_TOTALS");
+    // 预写日志要等确认是唯一实例后才由openStorage()打开，避免与正在运行的实例争用
     loadConfigFromFile();
+    {
+        TraceScope traceTemplates("DayTemplateStore::load");
+        m_templates.load(m_templateFilePath);
+    }
 }
 
 // 析构函数，释放资源并保存数据
+// 未打开存储时（例如检测到已有实例而退出）不写入任何文件，以免覆盖正在运行的实例的数据
 AppDatas::~AppDatas(){
-    saveDataToFile();
-    saveConfigToFile();
-    saveSettings();
+    if (m_storageOpened) {
+        stopSaveWorker();
+        // 没有未保存的修改且预写日志为空时存档已是最新，不再重写
+        if (m_studyStore.hasUnsavedChanges() || m_journalEntriesSinceSnapshot > 0) {
+            saveDataToFile();
+        }
+        saveConfigToFile();
+        saveSettings();
+        m_journal.close();
+    }
     
     if (m_appSettings) {
         delete m_appSettings;
@@ -32,6 +61,7 @@ AppDatas::~AppDatas(){
 // 初始化存档路径
 void AppDatas::initSavePath()
 {
+    TraceScope trace("AppDatas::initSavePath");
     QDir dir(m_appDataPath);
     if(!dir.exists())
     {
@@ -39,8 +69,13 @@ void AppDatas::initSavePath()
             qCritical() << "无法创建应用数据目录：" << m_appDataPath;
         }
     }
-    m_saveFilePath = m_appDataPath + "/study_data.json";
+    m_saveFilePath = m_appDataPath + "/study_data.dat";
+    m_legacySaveFilePath = m_appDataPath + "/study_data.json";
     m_logDirectory = m_appDataPath + "/logs";
+    m_journalFilePath = m_appDataPath + "/study_data.journal";
+    m_snapshotDirectory = m_appDataPath + "/snapshots";
+    m_templateFilePath = m_appDataPath + "/day_templates.json";
+    m_categoryFilePath = m_appDataPath + "/categories.json";
     
     QDir logDir(m_logDirectory);
     if(!logDir.exists())
@@ -59,6 +94,7 @@ void AppDatas::initSavePath()
 // 初始化配置文件
 void AppDatas::initConfigFile()
 {
+    TraceScope trace("AppDatas::initConfigFile");
     QDir dir(m_appDataPath);
     if(!dir.exists())
     {
@@ -102,6 +138,7 @@ void AppDatas::saveConfigToFile()
 // 从文件加载配置
 void AppDatas::loadConfigFromFile()
 {
+    TraceScope trace("AppDatas::loadConfigFromFile");
     QFile file(m_configFilePath);
     if(!file.exists()) {
         qDebug() << "配置文件不存在，将使用默认配置：" << m_configFilePath;
@@ -142,332 +179,175 @@ void AppDatas::loadConfigFromFile()
 }
 
 // 保存数据到文件
+// 后台保存线程运行时只提交快照，由后台线程写入磁盘
 void AppDatas::saveDataToFile()
 {
-    qDebug() << "开始保存学习数据...";
-    
-    QJsonObject rootObj;
-    rootObj.insert("maxContinuousDays", m_maxContinuousDays);
-    QJsonObject dateObj;
-
-    QMap<QDate, DateStudyData>::const_iterator dateIt = m_studyDataMap.constBegin();
-    while(dateIt != m_studyDataMap.constEnd())
-    {
-        QDate date = dateIt.key();
-        DateStudyData data = dateIt.value();
-        QString dateStr = date.toString("yyyy-MM-dd");
-
-        QJsonObject studyObj;
-        studyObj.insert("studyHours", data.studyHours);
-        studyObj.insert("completedProjects", data.completedProjects);
-        studyObj.insert("totalProjects", data.totalProjects);
-
-        QJsonObject timeAxisObj;
-        QMap<int, TimeAxisItem>::const_iterator timeIt = data.timeAxisData.constBegin();
-        while(timeIt != data.timeAxisData.constEnd())
-        {
-            int hour = timeIt.key();
-            TimeAxisItem item = timeIt.value();
-            QJsonObject itemObj;
-            itemObj.insert("type", item.type);
-            itemObj.insert("isCompleted", item.isCompleted);
-            timeAxisObj.insert(QString::number(hour), itemObj);
-            ++timeIt;
-        }
-        studyObj.insert("timeAxisData", timeAxisObj);
-        dateObj.insert(dateStr, studyObj);
-        ++dateIt;
+    if (!m_storageOpened) {
+        qWarning() << "存储尚未打开，不保存学习数据";
+        return;
     }
-    rootObj.insert("studyData", dateObj);
 
-    QJsonDocument doc(rootObj);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
-    if (jsonData.isEmpty()) {
-        qCritical() << "数据序列化失败，跳过保存";
+    // 只取出修改过的日期，由写入方映射磁盘上的存档合并编码，不在界面线程读取或解码全部历史
+    SaveSnapshot snapshot;
+    snapshot.editSerial = m_studyStore.editSerial();
+    snapshot.mergeArchive = m_studyStore.prepareSave(snapshot.days);
+    snapshot.maxContinuousDays = m_streaks.longestStreak();
+    snapshot.sequence = ++m_snapshotSequence;
+    m_journalEntriesSinceSnapshot = 0;
+
+    if (m_saveWorker) {
+        m_saveWorker->postSnapshot(snapshot);
         return;
     }
-    
-    qDebug() << "数据序列化成功，数据大小：" << jsonData.size() << "字节，包含" << m_studyDataMap.size() << "天的学习数据";
 
-    QString tempFilePath = m_saveFilePath + ".tmp";
-    QFile tempFile(tempFilePath);
-    if(!tempFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-        qCritical() << "临时文件打开失败：" << tempFilePath << "，错误：" << tempFile.errorString();
+    if (!SaveWorker::writeSnapshot(snapshot, m_saveFilePath, m_logDirectory)) {
         return;
     }
-    
-    qint64 written = tempFile.write(jsonData);
-    tempFile.close();
 
-    if (tempFile.error() != QFile::NoError) {
-        qCritical() << "临时文件写入过程中发生错误：" << tempFile.errorString();
-        QFile::remove(tempFilePath);
-        return;
+    // 存档已包含全部变更，清空预写日志
+    if (installSnapshot(snapshot.editSerial) && m_journal.isOpen()) {
+        m_journal.reset();
     }
+}
 
-    if (written != jsonData.size()) {
-        qCritical() << "临时文件写入不完整，预期写入" << jsonData.size() << "字节，实际写入" << written << "字节";
-        QFile::remove(tempFilePath);
+// 整体快照的临时文件写入完成后替换存档，并告知后台线程结果
+void AppDatas::onSnapshotWritten(bool ok, quint64 sequence, quint64 editSerial)
+{
+    // 写入失败时后台线程自行重试，数据继续保留在内存中
+    if (!ok) {
         return;
     }
-    
-    qDebug() << "临时文件写入成功：" << tempFilePath;
 
-    // 备份原有文件
-    QString backupFilePath = m_saveFilePath + ".bak";
-    bool backupSuccess = true;
-    
-    if (QFile::exists(m_saveFilePath)) {
-        // 删除旧备份
-        QFile::remove(backupFilePath);
-        
-        if (!QFile::rename(m_saveFilePath, backupFilePath)) {
-            qWarning() << "创建备份文件失败：" << backupFilePath;
-            backupSuccess = false;
-        } else {
-            qDebug() << "原有文件备份成功：" << backupFilePath;
-        }
+    const bool installed = installSnapshot(editSerial);
+    if (m_saveWorker) {
+        m_saveWorker->postSnapshotInstalled(sequence, installed);
     }
-    
-    // 替换原有文件
-    if (!QFile::rename(tempFilePath, m_saveFilePath)) {
-        qCritical() << "覆盖存档文件失败：" << m_saveFilePath;
-        QFile::remove(tempFilePath);
-        
-        // 尝试恢复备份
-        if (backupSuccess && QFile::exists(backupFilePath)) {
-            if (QFile::rename(backupFilePath, m_saveFilePath)) {
-                qDebug() << "从备份恢复存档文件成功";
-            } else {
-                qCritical() << "从备份恢复存档文件失败";
-            }
-        }
-        
+}
+
+// 用写好的临时文件替换存档并重新映射
+bool AppDatas::installSnapshot(quint64 editSerial)
+{
+    // 被映射的文件无法被替换，由存储释放映射、替换后立即重新映射，只保留快照之后发生的编辑
+    return m_studyStore.replaceArchive(m_saveFilePath, [this]() {
+        return SaveWorker::installSnapshot(m_saveFilePath);
+    }, editSerial);
+}
+
+// 确认是唯一实例后打开存储：清理过期日志、重放预写日志并启动后台保存线程
+void AppDatas::openStorage()
+{
+    if (m_storageOpened) {
         return;
     }
-    
-    qDebug() << "学习数据保存成功：" << m_saveFilePath;
-    
-    // 删除备份文件
-    QFile::remove(backupFilePath);
-    
-    // 保存数据后写入日志
-    saveLog();
+    m_storageOpened = true;
+
+    SaveWorker::cleanupOldLogs(m_logDirectory);
+    replayJournal();
+    startSaveWorker();
 }
 
-// 保存每日日志
-void AppDatas::saveLog()
+// 启动后台保存线程
+void AppDatas::startSaveWorker()
 {
-    QString logFileName = QDate::currentDate().toString("yyyy-MM-dd") + ".json";
-    QString logFilePath = m_logDirectory + "/" + logFileName;
-    
-    QJsonObject rootObj;
-    rootObj.insert("maxContinuousDays", m_maxContinuousDays);
-    QJsonObject dateObj;
-    
-    QDate currentDate = QDate::currentDate();
-    if (m_studyDataMap.contains(currentDate)) {
-        const DateStudyData& data = m_studyDataMap[currentDate];
-        QString dateStr = currentDate.toString("yyyy-MM-dd");
-        
-        QJsonObject studyObj;
-        studyObj.insert("studyHours", data.studyHours);
-        studyObj.insert("completedProjects", data.completedProjects);
-        studyObj.insert("totalProjects", data.totalProjects);
-        
-        QJsonObject timeAxisObj;
-        QMap<int, TimeAxisItem>::const_iterator timeIt = data.timeAxisData.constBegin();
-        while(timeIt != data.timeAxisData.constEnd())
-        {
-            int hour = timeIt.key();
-            const TimeAxisItem& item = timeIt.value();
-            QJsonObject itemObj;
-            itemObj.insert("type", item.type);
-            itemObj.insert("isCompleted", item.isCompleted);
-            timeAxisObj.insert(QString::number(hour), itemObj);
-            ++timeIt;
-        }
-        studyObj.insert("timeAxisData", timeAxisObj);
-        dateObj.insert(dateStr, studyObj);
-    }
-    
-    rootObj.insert("studyData", dateObj);
-    
-    QJsonDocument doc(rootObj);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
-    
-    QFile logFile(logFilePath);
-    if(!logFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-        qCritical() << "日志文件打开失败：" << logFilePath << "，错误：" << logFile.errorString();
+    if (m_saveWorker) {
         return;
     }
-    
-    qint64 bytesWritten = logFile.write(jsonData);
-    logFile.close();
-    
-    if (logFile.error() != QFile::NoError) {
-        qCritical() << "日志文件写入过程中发生错误：" << logFile.errorString();
-        return;
+
+    // 预写日志交由后台线程独占
+    m_journal.close();
+
+    m_saveWorker = new SaveWorker(m_saveFilePath, m_journalFilePath, m_logDirectory);
+    m_saveWorker->setDebounceInterval(m_saveDebounceMs);
+    QObject::connect(m_saveWorker, &SaveWorker::snapshotWritten, qApp, [this](bool ok, quint64 sequence, quint64 editSerial) {
+        onSnapshotWritten(ok, sequence, editSerial);
+    });
+
+    if (!m_saveWorker->start()) {
+        qWarning() << "后台保存线程启动失败，编辑将同步写入";
+        delete m_saveWorker;
+        m_saveWorker = nullptr;
+        m_journal.open(m_journalFilePath);
     }
-    
-    if (bytesWritten != jsonData.size()) {
-        qCritical() << "日志文件写入不完整，预期写入" << jsonData.size() << "字节，实际写入" << bytesWritten << "字节";
+}
+
+// 写出尚未落盘的数据并停止后台保存线程
+void AppDatas::stopSaveWorker()
+{
+    if (!m_saveWorker) {
         return;
     }
-    
-    qDebug() << "日志保存成功：" << logFilePath;
-    
-    // 清理旧日志
-    cleanupOldLogs();
+
+    m_saveWorker->stop();
+
+    // 事件循环可能已经结束，直接处理停止过程中发出的快照完成通知，替换存档并清空预写日志
+    if (qApp) {
+        QCoreApplication::sendPostedEvents(qApp, QEvent::MetaCall);
+    }
+
+    delete m_saveWorker;
+    m_saveWorker = nullptr;
+
+    if (!m_journal.open(m_journalFilePath)) {
+        qWarning() << "预写日志不可用，编辑将直接写入存档";
+    }
 }
 
-// 清理旧日志
-void AppDatas::cleanupOldLogs()
+// 阻塞直到已提交的编辑与保存全部写入磁盘
+void AppDatas::flushSaves()
 {
-    QDir logDir(m_logDirectory);
-    QFileInfoList logFiles = logDir.entryInfoList(QStringList() << "*.json", QDir::Files);
-    
-    QDate currentDate = QDate::currentDate();
-    int daysToKeep = 30;
-    
-    foreach (const QFileInfo& fileInfo, logFiles) {
-        QString fileName = fileInfo.fileName();
-        QString dateStr = fileName.left(10);
-        QDate logDate = QDate::fromString(dateStr, "yyyy-MM-dd");
-        
-        if (logDate.isValid()) {
-            int daysDiff = logDate.daysTo(currentDate);
-            if (daysDiff > daysToKeep) {
-                QString logFilePath = fileInfo.absoluteFilePath();
-                if (QFile::remove(logFilePath)) {
-                    qDebug() << "删除旧日志文件：" << logFilePath;
-                } else {
-                    qWarning() << "删除旧日志文件失败：" << logFilePath;
-                }
-            }
+    if (!m_saveWorker) {
+        return;
+    }
+    // 快照写好临时文件后由界面线程替换存档；等待替换时提交的新快照在确认送达后才会写入，最多需要两轮
+    for (int round = 0; round < 2; ++round) {
+        m_saveWorker->flush();
+        if (qApp) {
+            QCoreApplication::sendPostedEvents(qApp, QEvent::MetaCall);
         }
     }
 }
 
+// 设置合并写入的时间窗口
+void AppDatas::setSaveDebounceInterval(int ms)
+{
+    m_saveDebounceMs = qMax(0, ms);
+    if (m_saveWorker) {
+        m_saveWorker->setDebounceInterval(m_saveDebounceMs);
+    }
+}
+
 // 从日志读取数据
 // 返回：是否成功
 bool AppDatas::loadDataFromLogs()
 {
-    QDir logDir(m_logDirectory);
-    QFileInfoList logFiles = logDir.entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Time); // 按时间排序，最新的日志优先
-    
-    if (logFiles.isEmpty()) {
-        qDebug() << "没有找到日志文件";
+    // 日志集中在一个段文件中，按索引逐天读取，不扫描目录
+    StudyLogStore logs;
+    if (!logs.open(m_logDirectory) || logs.count() == 0) {
+        qDebug() << "没有找到日志";
         return false;
     }
     
     bool loaded = false;
     int maxContinuous = 0;
     int loadedDays = 0;
-    int processedLogs = 0;
     
-    qDebug() << "找到" << logFiles.size() << "个日志文件，开始从日志加载数据...";
+    qDebug() << "找到" << logs.count() << "天的日志，开始从日志加载数据...";
     
-    foreach (const QFileInfo& fileInfo, logFiles) {
-        QString logFilePath = fileInfo.absoluteFilePath();
-        processedLogs++;
-        
-        QFile logFile(logFilePath);
-        
-        if(!logFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            qWarning() << "日志文件打开失败：" << logFilePath << "，错误：" << logFile.errorString();
-            continue;
-        }
-        
-        QByteArray data = logFile.readAll();
-        logFile.close();
-        
-        if (logFile.error() != QFile::NoError) {
-            qCritical() << "关闭日志文件时发生错误：" << logFilePath << "，错误：" << logFile.errorString();
-            continue;
-        }
-        
-        if (data.isEmpty()) {
-            qWarning() << "日志文件为空：" << logFilePath;
-            continue;
-        }
-        
-        QJsonParseError error;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-        if(error.error != QJsonParseError::NoError) {
-            qWarning() << "日志JSON解析失败：" << logFilePath << "，错误：" << error.errorString();
-            continue;
-        }
-        
-        QJsonObject rootObj = doc.object();
-        
-        // 更新最大连续天数
-        if(rootObj.contains("maxContinuousDays")) {
-            int logMaxContinuous = rootObj["maxContinuousDays"].toInt();
-            if (logMaxContinuous > maxContinuous) {
-                maxContinuous = logMaxContinuous;
-            }
+    // 逐天直接写入存储，不构建中间容器
+    const int readDays = logs.readAll([&](const QDate& date, const DayRecord& record) {
+        // 如果已经存在该日期的数据，则跳过（避免覆盖）
+        if (m_studyStore.contains(date)) {
+            return;
         }
-        
-        // 加载学习数据
-        if(rootObj.contains("studyData"))
-        {
-            QJsonObject dateObj = rootObj["studyData"].toObject();
-            QStringList dateList = dateObj.keys();
-            
-            foreach (QString dateStr, dateList)
-            {
-                QDate date = QDate::fromString(dateStr, "yyyy-MM-dd");
-                if(!date.isValid()) {
-                    qWarning() << "日志文件" << logFilePath << "中存在无效的日期格式：" << dateStr;
-                    continue;
-                }
-                
-                // 如果已经存在该日期的数据，则跳过（避免覆盖）
-                if (m_studyDataMap.contains(date)) {
-                    continue;
-                }
-                
-                QJsonObject studyObj = dateObj[dateStr].toObject();
-                DateStudyData studyData;
-                studyData.studyHours = studyObj["studyHours"].toInt();
-                studyData.completedProjects = studyObj["completedProjects"].toInt();
-                studyData.totalProjects = studyObj["totalProjects"].toInt();
-                
-                // 加载时间轴数据
-                if (studyObj.contains("timeAxisData")) {
-                    QJsonObject timeAxisObj = studyObj["timeAxisData"].toObject();
-                    QStringList hourList = timeAxisObj.keys();
-                    
-                    foreach (QString hourStr, hourList)
-                    {
-                        bool ok;
-                        int hour = hourStr.toInt(&ok);
-                        if(!ok) {
-                            qWarning() << "日志文件" << logFilePath << "中存在无效的小时格式：" << hourStr;
-                            continue;
-                        }
-                        
-                        QJsonObject itemObj = timeAxisObj[hourStr].toObject();
-                        TimeAxisItem item;
-                        item.type = itemObj["type"].toString();
-                        item.isCompleted = itemObj["isCompleted"].toBool();
-                        studyData.timeAxisData.insert(hour, item);
-                    }
-                }
-                
-                m_studyDataMap.insert(date, studyData);
-                loadedDays++;
-                loaded = true;
-            }
-        }
-    }
+        (*this)[date] = record;
+        loadedDays++;
+        loaded = true;
+    }, maxContinuous);
     
     if (loaded) {
-        m_maxContinuousDays = maxContinuous;
-        qDebug() << "从" << processedLogs << "个日志文件中成功加载" << loadedDays << "天的学习数据，最大连续天数：" << maxContinuous;
+        qDebug() << "从" << readDays << "天的日志中成功加载" << loadedDays << "天的学习数据，最大连续天数：" << maxContinuous;
     } else {
-        qDebug() << "处理了" << processedLogs << "个日志文件，但没有加载到有效数据";
+        qDebug() << "读取了" << readDays << "天的日志，但没有加载到有效数据";
     }
     
     return loaded;
@@ -476,95 +356,45 @@ bool AppDatas::loadDataFromLogs()
 // 从文件加载数据
 void AppDatas::loadDataFromFile()
 {
+    TraceScope trace("AppDatas::loadDataFromFile");
     qDebug() << "开始加载学习数据...";
     
-    QFile file(m_saveFilePath);
-    if(file.exists()) {
-        qDebug() << "找到存档文件：" << m_saveFilePath;
+    // 优先以内存映射方式打开二进制存档，只读取索引，按需解码
+    if (QFile::exists(m_saveFilePath)) {
+        QString mapError;
+        if (m_studyStore.openMapped(m_saveFilePath, &mapError)) {
+            qDebug() << "存档记录的最大连续天数：" << m_studyStore.mappedMaxContinuousDays();
+            return;
+        }
+        qWarning() << "存档无法映射，改为完整读取：" << mapError;
+    }
+    
+    // 新存档不存在时，从旧版本的JSON存档迁移
+    QString loadPath = m_saveFilePath;
+    if (!QFile::exists(loadPath) && QFile::exists(m_legacySaveFilePath)) {
+        qDebug() << "未找到二进制存档，从旧版JSON存档迁移：" << m_legacySaveFilePath;
+        loadPath = m_legacySaveFilePath;
+    }
+    
+    if(QFile::exists(loadPath)) {
+        qDebug() << "找到存档文件：" << loadPath;
         
-        if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QByteArray data = file.readAll();
-            file.close();
-            
-            if (file.error() != QFile::NoError) {
-                qCritical() << "关闭存档文件时发生错误：" << file.errorString();
-            }
-            
-            if (!data.isEmpty()) {
-                QJsonParseError error;
-                QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-                if(error.error == QJsonParseError::NoError) {
-                    QJsonObject rootObj = doc.object();
-                    
-                    // 加载最大连续天数
-                    if(rootObj.contains("maxContinuousDays")) {
-                        m_maxContinuousDays = rootObj["maxContinuousDays"].toInt();
-                        qDebug() << "加载最大连续天数：" << m_maxContinuousDays;
-                    }
-                    
-                    // 加载学习数据
-                    if(rootObj.contains("studyData"))
-                    {
-                        QJsonObject dateObj = rootObj["studyData"].toObject();
-                        QStringList dateList = dateObj.keys();
-                        int loadedDays = 0;
-                        
-                        foreach (QString dateStr, dateList)
-                        {
-                            QDate date = QDate::fromString(dateStr, "yyyy-MM-dd");
-                            if(!date.isValid()) {
-                                qWarning() << "无效的日期格式：" << dateStr;
-                                continue;
-                            }
-                            
-                            QJsonObject studyObj = dateObj[dateStr].toObject();
-                            DateStudyData studyData;
-                            studyData.studyHours = studyObj["studyHours"].toInt();
-                            studyData.completedProjects = studyObj["completedProjects"].toInt();
-                            studyData.totalProjects = studyObj["totalProjects"].toInt();
-                            
-                            // 加载时间轴数据
-                            if (studyObj.contains("timeAxisData")) {
-                                QJsonObject timeAxisObj = studyObj["timeAxisData"].toObject();
-                                QStringList hourList = timeAxisObj.keys();
-                                
-                                foreach (QString hourStr, hourList)
-                                {
-                                    bool ok;
-                                    int hour = hourStr.toInt(&ok);
-                                    if(!ok) {
-                                        qWarning() << "无效的小时格式：" << hourStr;
-                                        continue;
-                                    }
-                                    
-                                    QJsonObject itemObj = timeAxisObj[hourStr].toObject();
-                                    TimeAxisItem item;
-                                    item.type = itemObj["type"].toString();
-                                    item.isCompleted = itemObj["isCompleted"].toBool();
-                                    studyData.timeAxisData.insert(hour, item);
-                                }
-                            }
-                            
-                            m_studyDataMap.insert(date, studyData);
-                            loadedDays++;
-                        }
-                        
-                        qDebug() << "成功从存档文件加载" << loadedDays << "天的学习数据";
-                        return;
-                    } else {
-                        qWarning() << "存档文件中没有studyData字段";
-                    }
-                } else {
-                    qCritical() << "存档JSON解析失败：" << error.errorString();
-                }
-            } else {
-                qWarning() << "存档文件为空";
-            }
-        } else {
-            qCritical() << "无法打开存档文件进行读取：" << m_saveFilePath << "，错误：" << file.errorString();
+        // 映射文件后流式解码，逐天放入容器，完整成功后整体交给存储
+        QMap<QDate, DayRecord> days;
+        int maxContinuous = 0;
+        QString errorString;
+        const bool ok = StudyCodec::decodeFile(loadPath, [&days](const QDate& date, const DayRecord& record) {
+            days.insert(date, record);
+        }, maxContinuous, &errorString);
+        if (ok) {
+            m_studyStore.replaceAll(days);
+            qDebug() << "存档记录的最大连续天数：" << maxContinuous;
+            qDebug() << "成功从存档文件加载" << days.size() << "天的学习数据";
+            return;
         }
+        qCritical() << "存档解析失败：" << loadPath << "，错误：" << errorString;
     } else {
-        qDebug() << "存档文件不存在：" << m_saveFilePath;
+        qDebug() << "存档文件不存在：" << loadPath;
     }
     
     qWarning() << "存档文件读取失败，尝试从日志恢复数据...";
@@ -573,14 +403,235 @@ void AppDatas::loadDataFromFile()
     if (loadDataFromLogs()) {
         qDebug() << "从日志恢复数据成功";
     } else {
-        // 日志读取失败，按照老办法创建（即保持m_studyDataMap为空，后续会自动创建）
+        // 日志读取失败，按照老办法创建（即保持m_studyStore为空，后续会自动创建）
         qDebug() << "日志读取失败，将使用空数据集";
     }
 }
 
+// 打开预写日志并重放其中尚未压缩的变更
+void AppDatas::replayJournal()
+{
+    TraceScope trace("AppDatas::replayJournal");
+    if (!m_journal.open(m_journalFilePath)) {
+        qWarning() << "预写日志不可用，编辑将直接写入存档";
+        return;
+    }
+
+    const QList<StudyJournal::Entry> entries = m_journal.readAll();
+    for (const StudyJournal::Entry& entry : entries) {
+        applyJournalEntry(entry);
+    }
+
+    m_journalEntriesSinceSnapshot = entries.size();
+    if (!entries.isEmpty()) {
+        qDebug() << "从预写日志重放" << entries.size() << "条变更";
+    }
+}
+
+// 将一条变更应用到内存数据
+// 参数1：变更记录
+void AppDatas::applyJournalEntry(const StudyJournal::Entry& entry)
+{
+    if (entry.op == StudyJournal::ApplyTemplate) {
+        for (QDate date = entry.date; date <= entry.endDate; date = date.addDays(1)) {
+            if (entry.weekdayMask & (1 << (date.dayOfWeek() - 1))) {
+                DayRecord& record = (*this)[date];
+                if (m_rollups.isBuilt()) {
+                    m_rollups.update(date, record, entry.dayTemplate);
+                }
+                record = entry.dayTemplate;
+                m_streaks.set(date, StreakIndex::qualifies(record));
+            }
+        }
+        return;
+    }
+
+    DayRecord& record = (*this)[entry.date];
+    const DayRecord before = m_rollups.isBuilt() ? record : DayRecord();
+
+    // 统计字段由DayRecord随时段修改同步维护
+    switch (entry.op) {
+    case StudyJournal::SetItem:
+        if (!record.setSlots(entry.slot, entry.slotCount, entry.category != CategoryTable::kInvalid ? entry.category : CategoryTable::idOf(entry.item.type), entry.item.isCompleted)) {
+            qWarning() << "忽略无效的时间轴事项：" << entry.date << entry.slot << entry.slotCount << entry.item.type;
+        }
+        break;
+    case StudyJournal::RemoveItem:
+        record.clearSlots(entry.slot, entry.slotCount);
+        break;
+    case StudyJournal::ClearDate:
+        record.clear();
+        break;
+    case StudyJournal::ApplyTemplate:
+        break;
+    }
+    m_streaks.set(entry.date, StreakIndex::qualifies(record));
+    if (m_rollups.isBuilt()) {
+        m_rollups.update(entry.date, before, record);
+    }
+}
+
+// 应用变更并追加写入日志，必要时触发压缩
+// 参数1：变更记录
+void AppDatas::commitJournalEntry(const StudyJournal::Entry& entry)
+{
+    applyJournalEntry(entry);
+    ++m_journalEntriesSinceSnapshot;
+    if (entry.op == StudyJournal::ApplyTemplate) {
+        emit rangeChanged(entry.date, entry.endDate);
+    } else {
+        emit dayChanged(entry.date);
+    }
+
+    if (m_saveWorker) {
+        // 由后台线程在合并窗口结束后批量写入并刷盘
+        m_saveWorker->postJournalEntry(entry);
+    } else if (!m_journal.isOpen() || !m_journal.append(entry)) {
+        // 日志不可用时退回到整体保存，保证数据不丢失
+        saveDataToFile();
+        return;
+    }
+
+    if (m_journalEntriesSinceSnapshot >= kJournalCompactThreshold) {
+        qDebug() << "预写日志达到" << m_journalEntriesSinceSnapshot << "条，压缩到存档";
+        saveDataToFile();
+    }
+}
+
+// 设置指定日期连续若干时段的时间轴事项，并追加写入日志
+void AppDatas::setTimeAxisItem(const QDate& date, int slot, int slotCount, const TimeAxisItem& item)
+{
+    StudyJournal::Entry entry;
+    entry.op = StudyJournal::SetItem;
+    entry.date = date;
+    entry.slot = slot;
+    entry.slotCount = slotCount;
+    entry.item = item;
+    commitJournalEntry(entry);
+}
+
+// 按类型编号设置时间轴事项，日志中仍按名称保存类型
+void AppDatas::setTimeAxisItem(const QDate& date, int slot, int slotCount, quint8 category, bool isCompleted)
+{
+    StudyJournal::Entry entry;
+    entry.op = StudyJournal::SetItem;
+    entry.date = date;
+    entry.slot = slot;
+    entry.slotCount = slotCount;
+    entry.item = {CategoryTable::nameOf(category), isCompleted};
+    entry.category = category;
+    commitJournalEntry(entry);
+}
+
+// 清除指定日期连续若干时段的时间轴事项，并追加写入日志
+void AppDatas::removeTimeAxisItem(const QDate& date, int slot, int slotCount)
+{
+    StudyJournal::Entry entry;
+    entry.op = StudyJournal::RemoveItem;
+    entry.date = date;
+    entry.slot = slot;
+    entry.slotCount = slotCount;
+    commitJournalEntry(entry);
+}
+
+// 清空指定日期的全部学习数据，并追加写入日志
+void AppDatas::clearDateData(const QDate& date)
+{
+    StudyJournal::Entry entry;
+    entry.op = StudyJournal::ClearDate;
+    entry.date = date;
+    commitJournalEntry(entry);
+}
+
+// 把模板整体套用到日期区间内的指定星期
+// 整个批量修改只追加一条日志记录、只发出一次rangeChanged，存档的整体重写留给日志压缩
+int AppDatas::applyTemplate(const DayRecord& dayTemplate, const QDate& from, const QDate& to, int weekdayMask)
+{
+    if (!from.isValid() || !to.isValid() || from > to || (weekdayMask & 0x7F) == 0) {
+        return 0;
+    }
+    if (dayTemplate.totalProjects == 0) {
+        qWarning() << "模板没有任何时段，不套用";
+        return 0;
+    }
+
+    int applied = 0;
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        if (weekdayMask & (1 << (date.dayOfWeek() - 1))) {
+            ++applied;
+        }
+    }
+    if (applied == 0) {
+        return 0;
+    }
+
+    StudyJournal::Entry entry;
+    entry.op = StudyJournal::ApplyTemplate;
+    entry.date = from;
+    entry.endDate = to;
+    entry.weekdayMask = weekdayMask & 0x7F;
+    // 套用到的日期尚未发生，时段一律为未完成
+    entry.dayTemplate = dayTemplate;
+    entry.dayTemplate.clearCompleted();
+    commitJournalEntry(entry);
+    qDebug() << "模板已套用到" << applied << "天：" << from << "至" << to;
+    return applied;
+}
+
+// 批量修改并新增事项类型，全部属性生效后最多重新计算一次学习时长
+void AppDatas::updateCategories(const QList<CategoryTable::Category>& categories)
+{
+    // 同名类型已有记录时，新增类型引起的是否计入学习的变化同样需要重新计算
+    if (m_categories.update(categories)) {
+        recountStudyMinutes();
+    }
+    emit categoriesChanged();
+}
+
+// 按当前类型属性重新计算全部记录的学习时长
+// 存档索引中的学习时长同样过期，重新计算后整体保存一次
+void AppDatas::recountStudyMinutes()
+{
+    TraceScope trace("AppDatas::recountStudyMinutes");
+    QMap<QDate, DayRecord> days = m_studyStore.toMap();
+    for (DayRecord& record : days) {
+        record.recount();
+    }
+    m_studyStore.replaceAll(days);
+    recomputeTotals();
+    rebuildStreaks();
+    m_rollups.clear();
+    saveDataToFile();
+    emit dataReset();
+    qDebug() << "已按新的类型设置重新计算" << days.size() << "天的学习时长";
+}
+
+// 设置学习目标小时数
+void AppDatas::setTargetHour(int targetHour)
+{
+    if (m_studyTargetHour == targetHour) {
+        return;
+    }
+    m_studyTargetHour = targetHour;
+    // 达标天数随目标变化，汇总在下次读取时重建
+    m_rollups.clear();
+    emit targetHourChanged(targetHour);
+}
+
+// 设置时间轴一格的分钟数
+void AppDatas::setSlotMinutes(int minutes)
+{
+    if (!isValidSlotMinutes(minutes) || m_slotMinutes == minutes) {
+        return;
+    }
+    m_slotMinutes = minutes;
+    emit slotMinutesChanged(minutes);
+}
+
 // 初始化设置
 void AppDatas::initSettings()
 {
+    TraceScope trace("AppDatas::initSettings");
     m_isAutoStartup = m_appSettings->value("auto_startup", false).toBool();
     setAutoStartup(m_isAutoStartup);
 
@@ -593,6 +644,16 @@ void AppDatas::initSettings()
     
     // 加载默认视图设置
     m_defaultViewType = m_appSettings->value("default_view_type", 0).toInt();
+
+    // 加载合并写入时间窗口
+    m_saveDebounceMs = qMax(0, m_appSettings->value("save_debounce_ms", 500).toInt());
+
+    // 加载时间轴粒度，无效值退回到一小时
+    m_slotMinutes = m_appSettings->value("slot_minutes", 60).toInt();
+    if (!isValidSlotMinutes(m_slotMinutes)) {
+        qWarning() << "设置中的时间轴粒度无效(" << m_slotMinutes << ")，将使用默认值60分钟";
+        m_slotMinutes = 60;
+    }
 }
 
 // 保存设置
@@ -609,6 +670,12 @@ void AppDatas::saveSettings()
     // 保存默认视图设置
     m_appSettings->setValue("default_view_type", m_defaultViewType);
     
+    // 保存合并写入时间窗口
+    m_appSettings->setValue("save_debounce_ms", m_saveDebounceMs);
+
+    // 保存时间轴粒度
+    m_appSettings->setValue("slot_minutes", m_slotMinutes);
+    
     m_appSettings->sync();
 }
 
@@ -616,6 +683,7 @@ void AppDatas::saveSettings()
 // 参数1：是否自动启动
 void AppDatas::setAutoStartup(bool isAuto)
 {
+    TraceScope trace("AppDatas::setAutoStartup");
     m_isAutoStartup = isAuto;
     
     // 使用注册表方式设置开机自启
@@ -631,89 +699,82 @@ void AppDatas::setAutoStartup(bool isAuto)
 }
 
 // 获取指定类型的路径
-// 参数1：路径类型，支持"Root"、"Save"、"Config"、"Log"
+// 参数1：路径类型，支持"Root"、"Save"、"Config"、"Log"、"Journal"、"Snapshot"、"Template"、"Category"
 // 返回：路径字符串
 const QString& AppDatas::path(QString type){
     return type=="Root"?m_appDataPath:
                type=="Save"?m_saveFilePath:
                type=="Config"?m_configFilePath:
                type=="Log"?m_logDirectory:
+               type=="Journal"?m_journalFilePath:
+               type=="Snapshot"?m_snapshotDirectory:
+               type=="Template"?m_templateFilePath:
+               type=="Category"?m_categoryFilePath:
                m_appDataPath;
 }
 
-// 计算连续学习天数
+// 计算连续学习天数，今天尚未学习时计算到昨天为止
 // 返回：连续学习天数
-int AppDatas::calculateContinuousDays()
+int AppDatas::calculateContinuousDays() const
 {
-    int days = 0;
-    QDate current = QDate::currentDate();
-    while (contains(current)) {
-        days++;
-        current = current.addDays(-1);
-    }
-    return days;
+    return m_streaks.currentStreak(QDate::currentDate());
+}
+
+// 从头重建连续天数索引，只读取统计字段
+void AppDatas::rebuildStreaks()
+{
+    TraceScope trace("AppDatas::rebuildStreaks");
+    m_streaks.clear();
+    m_studyStore.forEachSummary([this](const QDate& date, const DayRecord& record) {
+        if (StreakIndex::qualifies(record)) {
+            m_streaks.set(date, true);
+        }
+    });
+}
+
+// 获取按周、月、年的预先汇总，未建立时遍历全部历史建立
+const StudyRollups& AppDatas::rollups() const
+{
+    if (!m_rollups.isBuilt()) {
+        TraceScope trace("AppDatas::buildRollups");
+        m_rollups.clear();
+        m_rollups.setTargetHours(m_studyTargetHour);
+        m_studyStore.forEachInRange(QDate(), QDate(), [this](const QDate& date, const DayRecord& record) {
+            m_rollups.addDay(date, record, 1);
+        });
+        m_rollups.setBuilt();
+    }
+    return m_rollups;
 }
 
 // 创建数据备份
-// 参数1：备份文件路径
+// 参数1：备份文件路径，后缀为.json时导出为JSON，否则为二进制
 // 返回：是否成功
 bool AppDatas::createBackup(const QString& backupPath)
 {
     qDebug() << "开始创建数据备份：" << backupPath;
     
+    // 等待后台线程写完已提交的编辑，保证备份与磁盘上的存档一致
+    flushSaves();
+    
     // 构建备份数据
-    QJsonObject rootObj;
-    rootObj.insert("maxContinuousDays", m_maxContinuousDays);
-    QJsonObject dateObj;
-
-    QMap<QDate, DateStudyData>::const_iterator dateIt = m_studyDataMap.constBegin();
-    while(dateIt != m_studyDataMap.constEnd())
-    {
-        QDate date = dateIt.key();
-        DateStudyData data = dateIt.value();
-        QString dateStr = date.toString("yyyy-MM-dd");
-
-        QJsonObject studyObj;
-        studyObj.insert("studyHours", data.studyHours);
-        studyObj.insert("completedProjects", data.completedProjects);
-        studyObj.insert("totalProjects", data.totalProjects);
-
-        QJsonObject timeAxisObj;
-        QMap<int, TimeAxisItem>::const_iterator timeIt = data.timeAxisData.constBegin();
-        while(timeIt != data.timeAxisData.constEnd())
-        {
-            int hour = timeIt.key();
-            TimeAxisItem item = timeIt.value();
-            QJsonObject itemObj;
-            itemObj.insert("type", item.type);
-            itemObj.insert("isCompleted", item.isCompleted);
-            timeAxisObj.insert(QString::number(hour), itemObj);
-            ++timeIt;
-        }
-        studyObj.insert("timeAxisData", timeAxisObj);
-        dateObj.insert(dateStr, studyObj);
-        ++dateIt;
-    }
-    rootObj.insert("studyData", dateObj);
-
-    QJsonDocument doc(rootObj);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
-    if (jsonData.isEmpty()) {
+    QByteArray backupData = StudyCodec::encode(m_studyStore.toMap(), m_streaks.longestStreak(), StudyCodec::formatForPath(backupPath));
+    if (backupData.isEmpty()) {
         qCritical() << "备份数据序列化失败";
         return false;
     }
     
-    qDebug() << "备份数据序列化成功，数据大小：" << jsonData.size() << "字节，包含" << m_studyDataMap.size() << "天的学习数据";
+    qDebug() << "备份数据序列化成功，数据大小：" << backupData.size() << "字节，包含" << m_studyStore.size() << "天的学习数据";
 
     // 创建临时文件，确保写入完整
     QString tempBackupPath = backupPath + ".tmp";
     QFile tempFile(tempBackupPath);
-    if(!tempFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+    if(!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
         qCritical() << "无法打开备份临时文件进行写入：" << tempBackupPath << "，错误：" << tempFile.errorString();
         return false;
     }
     
-    qint64 written = tempFile.write(jsonData);
+    qint64 written = tempFile.write(backupData);
     tempFile.close();
 
     if (tempFile.error() != QFile::NoError) {
@@ -722,8 +783,8 @@ bool AppDatas::createBackup(const QString& backupPath)
         return false;
     }
 
-    if (written != jsonData.size()) {
-        qCritical() << "备份临时文件写入不完整，预期写入" << jsonData.size() << "字节，实际写入" << written << "字节";
+    if (written != backupData.size()) {
+        qCritical() << "备份临时文件写入不完整，预期写入" << backupData.size() << "字节，实际写入" << written << "字节";
         QFile::remove(tempBackupPath);
         return false;
     }
@@ -731,6 +792,7 @@ bool AppDatas::createBackup(const QString& backupPath)
     qDebug() << "备份临时文件写入成功：" << tempBackupPath;
 
     // 替换最终备份文件
+    QFile::remove(backupPath);
     if (!QFile::rename(tempBackupPath, backupPath)) {
         qCritical() << "替换备份文件失败：" << backupPath;
         QFile::remove(tempBackupPath);
@@ -741,125 +803,99 @@ bool AppDatas::createBackup(const QString& backupPath)
     return true;
 }
 
-// 从备份恢复数据
-// 参数1：备份文件路径
+// 创建增量快照
+// 参数1：输出，快照清单路径，可为nullptr
 // 返回：是否成功
-bool AppDatas::restoreFromBackup(const QString& backupPath)
+bool AppDatas::createSnapshot(QString* manifestPath)
 {
-    qDebug() << "开始从备份恢复数据：" << backupPath;
-    
-    QFile backupFile(backupPath);
-    if(!backupFile.exists()) {
-        qCritical() << "备份文件不存在：" << backupPath;
-        return false;
+    qDebug() << "开始创建增量快照：" << m_snapshotDirectory;
+    
+    // 等待后台线程写完已提交的编辑，保证快照与磁盘上的存档一致
+    flushSaves();
+    
+    SnapshotStore snapshots(m_snapshotDirectory);
+    SnapshotStore::Manifest manifest;
+    int writtenChunks = 0;
+    bool ok = false;
+
+    // 本次运行已有快照且数据未被整体替换时，只重新编码之后修改过的月份，其余沿用上一份清单的分块
+    if (m_hasSnapshotManifest && !m_studyStore.monthsReplaced()) {
+        QMap<QDate, QMap<QDate, DayRecord>> changedMonths;
+        for (const QDate& month : m_studyStore.changedMonths()) {
+            QMap<QDate, DayRecord>& monthDays = changedMonths[month];
+            m_studyStore.forEachInRange(month, month.addMonths(1).addDays(-1), [&monthDays](const QDate& date, const DayRecord& record) {
+                monthDays.insert(date, record);
+            });
+        }
+        ok = snapshots.createFrom(m_lastSnapshotManifest, changedMonths, m_streaks.longestStreak(), manifestPath, &writtenChunks, &manifest);
+        if (!ok) {
+            qWarning() << "无法沿用上一份快照，改为完整创建";
+        }
     }
-    
-    if(!backupFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qCritical() << "无法打开备份文件进行读取：" << backupPath << "，错误：" << backupFile.errorString();
+    if (!ok && !snapshots.create(m_studyStore.toMap(), m_streaks.longestStreak(), manifestPath, &writtenChunks, &manifest)) {
+        qCritical() << "增量快照创建失败";
         return false;
     }
 
-    QByteArray data = backupFile.readAll();
-    backupFile.close();
-    
-    if (backupFile.error() != QFile::NoError) {
-        qCritical() << "关闭备份文件时发生错误：" << backupFile.errorString();
-        return false;
-    }
-    
-    if (data.isEmpty()) {
-        qCritical() << "备份文件为空：" << backupPath;
-        return false;
-    }
+    m_lastSnapshotManifest = manifest;
+    m_hasSnapshotManifest = true;
+    m_studyStore.clearChangedMonths();
+    snapshots.prune();
+    return true;
+}
+
+// 从备份恢复数据
+// 参数1：备份文件路径，自动识别二进制或JSON格式
+// 返回：是否成功
+bool AppDatas::restoreFromBackup(const QString& backupPath)
+{
+    qDebug() << "开始从备份恢复数据：" << backupPath;
     
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-    if(error.error != QJsonParseError::NoError) {
-        qCritical() << "备份文件JSON解析失败：" << backupPath << "，错误：" << error.errorString();
+    if(!QFile::exists(backupPath)) {
+        qCritical() << "备份文件不存在：" << backupPath;
         return false;
     }
     
     // 临时保存恢复的数据，确保完整解析后再替换
-    QMap<QDate, DateStudyData> tempStudyDataMap;
-    int tempMaxContinuousDays = m_maxContinuousDays;
-    
-    QJsonObject rootObj = doc.object();
-    
-    // 加载最大连续天数
-    if(rootObj.contains("maxContinuousDays")) {
-        tempMaxContinuousDays = rootObj["maxContinuousDays"].toInt();
-        qDebug() << "从备份加载最大连续天数：" << tempMaxContinuousDays;
-    }
-    
-    // 加载学习数据
-    if(rootObj.contains("studyData"))
-    {
-        QJsonObject dateObj = rootObj["studyData"].toObject();
-        QStringList dateList = dateObj.keys();
-        int loadedDays = 0;
-        
-        foreach (QString dateStr, dateList)
-        {
-            QDate date = QDate::fromString(dateStr, "yyyy-MM-dd");
-            if(!date.isValid()) {
-                qWarning() << "备份文件中存在无效的日期格式：" << dateStr;
-                continue;
-            }
-            
-            QJsonObject studyObj = dateObj[dateStr].toObject();
-            DateStudyData studyData;
-            studyData.studyHours = studyObj["studyHours"].toInt();
-            studyData.completedProjects = studyObj["completedProjects"].toInt();
-            studyData.totalProjects = studyObj["totalProjects"].toInt();
-            
-            // 加载时间轴数据
-            if (studyObj.contains("timeAxisData")) {
-                QJsonObject timeAxisObj = studyObj["timeAxisData"].toObject();
-                QStringList hourList = timeAxisObj.keys();
-                
-                foreach (QString hourStr, hourList)
-                {
-                    bool ok;
-                    int hour = hourStr.toInt(&ok);
-                    if(!ok) {
-                        qWarning() << "备份文件中存在无效的小时格式：" << hourStr;
-                        continue;
-                    }
-                    
-                    QJsonObject itemObj = timeAxisObj[hourStr].toObject();
-                    TimeAxisItem item;
-                    item.type = itemObj["type"].toString();
-                    item.isCompleted = itemObj["isCompleted"].toBool();
-                    studyData.timeAxisData.insert(hour, item);
-                }
-            }
-            
-            tempStudyDataMap.insert(date, studyData);
-            loadedDays++;
-        }
-        
-        qDebug() << "成功从备份文件加载" << loadedDays << "天的学习数据";
-    } else {
-        qWarning() << "备份文件中没有studyData字段";
+    // 备份文件以内存映射方式流式解码，损坏的日期跳过并记录偏移
+    QMap<QDate, DayRecord> tempStudyDataMap;
+    int tempMaxContinuousDays = 0;
+    QString errorString;
+    const auto collect = [&tempStudyDataMap](const QDate& date, const DayRecord& record) {
+        tempStudyDataMap.insert(date, record);
+    };
+    // 快照清单按月份分块重建，其余文件按存档格式解码
+    const bool ok = SnapshotStore::isManifest(backupPath)
+        ? SnapshotStore(QFileInfo(backupPath).absolutePath()).restore(backupPath, collect, tempMaxContinuousDays, &errorString)
+        : StudyCodec::decodeFile(backupPath, collect, tempMaxContinuousDays, &errorString);
+    if (!ok) {
+        qCritical() << "备份文件解析失败：" << backupPath << "，错误：" << errorString;
         return false;
     }
     
-    // 备份当前数据，以便恢复失败时可以回滚
-    QString currentBackupPath = m_saveFilePath + ".restore.bak";
-    if (createBackup(currentBackupPath)) {
-        qDebug() << "恢复前已创建当前数据的临时备份：" << currentBackupPath;
+    qDebug() << "从备份加载最大连续天数：" << tempMaxContinuousDays;
+    qDebug() << "成功从备份文件加载" << tempStudyDataMap.size() << "天的学习数据";
+    
+    // 以增量快照备份当前数据，以便恢复失败时可以回滚，未变化的月份不会重复写入
+    QString currentBackupPath;
+    if (createSnapshot(&currentBackupPath)) {
+        qDebug() << "恢复前已创建当前数据的快照：" << currentBackupPath;
     } else {
         qWarning() << "无法创建恢复前的临时备份，将继续恢复操作";
     }
     
     // 替换当前数据
-    m_studyDataMap = tempStudyDataMap;
-    m_maxContinuousDays = tempMaxContinuousDays;
+    m_studyStore.replaceAll(tempStudyDataMap);
+    recomputeTotals();
+    rebuildStreaks();
+    m_rollups.clear();
+    emit dataReset();
     
-    // 保存恢复后的数据到主文件
+    // 保存恢复后的数据到主文件，并等待写入完成
     saveDataToFile();
+    flushSaves();
     
-    qDebug() << "数据恢复成功，共恢复" << m_studyDataMap.size() << "天的学习数据";
+    qDebug() << "数据恢复成功，共恢复" << m_studyStore.size() << "天的学习数据";
     return true;
 }
 
@@ -867,90 +903,120 @@ bool AppDatas::restoreFromBackup(const QString& backupPath)
 // 返回：总学习天数
 int AppDatas::getTotalStudyDays() const
 {
-    int totalDays = 0;
-    QMap<QDate, DateStudyData>::const_iterator it = m_studyDataMap.constBegin();
-    while (it != m_studyDataMap.constEnd()) {
-        totalDays++;
-        ++it;
-    }
-    return totalDays;
+    return runningTotals().days;
 }
 
 // 获取总学习时长（小时）
 // 返回：总学习时长
-int AppDatas::getTotalStudyHours() const
+double AppDatas::getTotalStudyHours() const
 {
-    int totalHours = 0;
-    QMap<QDate, DateStudyData>::const_iterator it = m_studyDataMap.constBegin();
-    while (it != m_studyDataMap.constEnd()) {
-        totalHours += it.value().studyHours;
-        ++it;
-    }
-    return totalHours;
+    return runningTotals().studyMinutes / 60.0;
 }
 
 // 获取平均每天学习时长（小时）
 // 返回：平均每天学习时长
 double AppDatas::getAverageStudyHoursPerDay() const
 {
-    int totalDays = getTotalStudyDays();
-    if (totalDays == 0) {
+    const StudyColumns::Totals& totals = runningTotals();
+    if (totals.days == 0) {
         return 0.0;
     }
-    return static_cast<double>(getTotalStudyHours()) / totalDays;
+    return totals.studyMinutes / 60.0 / totals.days;
 }
 
 // 获取总项目数
 // 返回：总项目数
 int AppDatas::getTotalProjects() const
 {
-    int totalProjects = 0;
-    QMap<QDate, DateStudyData>::const_iterator it = m_studyDataMap.constBegin();
-    while (it != m_studyDataMap.constEnd()) {
-        totalProjects += it.value().totalProjects;
-        ++it;
-    }
-    return totalProjects;
+    return runningTotals().totalProjects;
 }
 
 // 获取完成项目数
 // 返回：完成项目数
 int AppDatas::getCompletedProjects() const
 {
-    int completedProjects = 0;
-    QMap<QDate, DateStudyData>::const_iterator it = m_studyDataMap.constBegin();
-    while (it != m_studyDataMap.constEnd()) {
-        completedProjects += it.value().completedProjects;
-        ++it;
-    }
-    return completedProjects;
+    return runningTotals().completedProjects;
 }
 
 // 获取项目完成率（百分比）
 // 返回：项目完成率
 double AppDatas::getProjectCompletionRate() const
 {
-    int totalProjects = getTotalProjects();
-    if (totalProjects == 0) {
+    const StudyColumns::Totals& totals = runningTotals();
+    if (totals.totalProjects == 0) {
         return 0.0;
     }
-    return static_cast<double>(getCompletedProjects()) / totalProjects * 100.0;
+    return static_cast<double>(totals.completedProjects) / totals.totalProjects * 100.0;
 }
 
-// 获取最近N天的学习数据
-// 参数1：天数
-// 返回：最近N天的学习数据，键为日期，值为学习数据
-QMap<QDate, DateStudyData> AppDatas::getRecentStudyData(int days) const
+// 访问指定日期的单日记录以便修改
+// 先从累计统计中扣除该日旧值，下次读取统计时再加回新值，
+// 因此通过返回的引用所做的任何修改都会反映到累计统计中
+DayRecord& AppDatas::operator[](const QDate& key)
 {
-    QMap<QDate, DateStudyData> recentData;
-    QDate currentDate = QDate::currentDate();
-    
-    for (int i = 0; i < days; ++i) {
-        QDate date = currentDate.addDays(-i);
-        if (m_studyDataMap.contains(date)) {
-            recentData.insert(date, m_studyDataMap[date]);
+    if (!m_totalsPending.contains(key)) {
+        if (m_studyStore.contains(key)) {
+            const DayRecord old = m_studyStore.record(key);
+            m_totals.studyMinutes -= old.studyMinutes;
+            m_totals.completedProjects -= old.completedProjects;
+            m_totals.totalProjects -= old.totalProjects;
+        } else {
+            m_totals.days += 1;
         }
+        m_totalsPending.insert(key);
     }
-    
-    return recentData;
+    return m_studyStore[key];
+}
+
+// 获取累计统计，先结算等待加回的日期
+const StudyColumns::Totals& AppDatas::runningTotals() const
+{
+    for (const QDate& date : std::as_const(m_totalsPending)) {
+        const DayRecord record = m_studyStore.record(date);
+        m_totals.studyMinutes += record.studyMinutes;
+        m_totals.completedProjects += record.completedProjects;
+        m_totals.totalProjects += record.totalProjects;
+    }
+    m_totalsPending.clear();
+
+    if (m_validateTotals) {
+        verifyTotals();
+    }
+    return m_totals;
+}
+
+// 从头重新计算累计统计（整体替换数据后调用）
+void AppDatas::recomputeTotals()
+{
+    m_totalsPending.clear();
+    m_totals = m_studyStore.totals();
+}
+
+// 全量扫描校验累计统计
+// 返回：是否一致
+bool AppDatas::verifyTotals() const
+{
+    StudyColumns::Totals expected;
+    m_studyStore.forEachSummary([&](const QDate&, const DayRecord& record) {
+        expected.days += 1;
+        expected.studyMinutes += record.studyMinutes;
+        expected.completedProjects += record.completedProjects;
+        expected.totalProjects += record.totalProjects;
+    });
+
+    // 校验前结算尚未加回的日期（不递归进入校验）
+    const bool validate = m_validateTotals;
+    m_validateTotals = false;
+    const StudyColumns::Totals& actual = runningTotals();
+    m_validateTotals = validate;
+
+    if (expected.days != actual.days || expected.studyMinutes != actual.studyMinutes
+        || expected.completedProjects != actual.completedProjects || expected.totalProjects != actual.totalProjects) {
+        qCritical() << "累计统计与全量扫描不一致：天数" << actual.days << "/" << expected.days
+                    << "，学习分钟数" << actual.studyMinutes << "/" << expected.studyMinutes
+                    << "，完成数" << actual.completedProjects << "/" << expected.completedProjects
+                    << "，总数" << actual.totalProjects << "/" << expected.totalProjects;
+        return false;
+    }
+    return true;
 }
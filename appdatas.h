@@ -5,6 +5,7 @@
 #include <QDir>
 #include <QFile>
 #include <QJsonObject>
+#include <QObject>
 #include <QString>
 #include <QProcessEnvironment>
 #include <QSettings>
@@ -13,10 +14,20 @@
 
 // 包含服务管理类
 #include "windowservice/service.h"
+#include "utils/studyjournal.h"
+#include "utils/studystore.h"
+#include "utils/saveworker.h"
+#include "utils/snapshotstore.h"
+#include "utils/daytemplatestore.h"
+#include "utils/streakindex.h"
+#include "utils/studyrollups.h"
+#include "utils/categoryregistry.h"
 
 // 应用数据管理类，负责用户数据读取与存储
-class AppDatas
+// 数据变化时发出带类型的信号，各视图只刷新受影响的部分
+class AppDatas : public QObject
 {
+    Q_OBJECT
 public:
     // 构造函数，初始化应用数据管理
     AppDatas();
@@ -48,6 +59,92 @@ public:
     // 保存设置
     void saveSettings();
 
+    // 确认是唯一实例后打开存储：重放预写日志并启动后台保存线程
+    // 在此之前只读取存档，不写入任何数据文件；未调用时退出也不保存
+    // 需要在QApplication创建之后调用
+    void openStorage();
+
+    // 启动后台保存线程，之后的编辑与保存都在后台线程写入磁盘
+    // 需要在QApplication创建之后调用
+    void startSaveWorker();
+
+    // 写出尚未落盘的数据并停止后台保存线程，之后恢复同步写入
+    void stopSaveWorker();
+
+    // 阻塞直到已提交的编辑与保存全部写入磁盘
+    void flushSaves();
+
+signals:
+    // 某一天的数据发生变化
+    // 参数1：日期
+    void dayChanged(const QDate& date);
+
+    // 每日学习目标发生变化
+    // 参数1：学习目标小时数
+    void targetHourChanged(int targetHour);
+
+    // 全部数据被整体替换（如从备份恢复）
+    void dataReset();
+
+    // 一段日期区间内的数据被批量修改（如套用模板），区间内的日期不再逐天发出dayChanged
+    // 参数1：起始日期（含）
+    // 参数2：结束日期（含）
+    void rangeChanged(const QDate& from, const QDate& to);
+
+    // 时间轴粒度发生变化
+    // 参数1：一格的分钟数
+    void slotMinutesChanged(int minutes);
+
+    // 事项类型新增或属性（配色、是否计入学习、目标）发生变化
+    void categoriesChanged();
+
+public:
+    // 设置指定日期连续若干时段的时间轴事项，并追加写入日志
+    // 参数1：日期
+    // 参数2：第一个15分钟时段的序号
+    // 参数3：时段数
+    // 参数4：事项
+    void setTimeAxisItem(const QDate& date, int slot, int slotCount, const TimeAxisItem& item);
+
+    // 按类型编号设置时间轴事项，应用到内存时不再按名称查找类型
+    // 参数1：日期
+    // 参数2：第一个15分钟时段的序号
+    // 参数3：时段数
+    // 参数4：类型编号
+    // 参数5：是否完成
+    void setTimeAxisItem(const QDate& date, int slot, int slotCount, quint8 category, bool isCompleted);
+
+    // 清除指定日期连续若干时段的时间轴事项，并追加写入日志
+    // 参数1：日期
+    // 参数2：第一个15分钟时段的序号
+    // 参数3：时段数
+    void removeTimeAxisItem(const QDate& date, int slot, int slotCount);
+
+    // 清空指定日期的全部学习数据，并追加写入日志
+    // 参数1：日期
+    void clearDateData(const QDate& date);
+
+    // 把模板整体套用到日期区间内的指定星期，作为一次批量修改：
+    // 只追加一条日志记录，只发出一次rangeChanged
+    // 参数1：模板记录
+    // 参数2：起始日期（含）
+    // 参数3：结束日期（含）
+    // 参数4：星期掩码，第(星期几-1)位为1表示套用（周一为第0位）
+    // 返回：套用的天数，模板没有时段时不套用并返回0
+    int applyTemplate(const DayRecord& dayTemplate, const QDate& from, const QDate& to, int weekdayMask = 0x7F);
+
+    // 日程模板
+    DayTemplateStore& templates(){return m_templates;}
+
+    // 事项类型
+    const CategoryRegistry& categories() const {return m_categories;}
+
+    // 批量修改事项类型的配色、是否计入学习时长与每日目标，并新增类型
+    // 全部修改完成后只写入一次类型文件；有类型的“计入学习时长”变化时
+    // 只重新计算一次全部记录的学习时长并整体保存，随后发出dataReset
+    // 参数1：按编号排列的类型，超出现有类型数的部分按名称新增
+    void updateCategories(const QList<CategoryTable::Category>& categories);
+
 public:
     // 设置是否自动启动
     // 参数1：是否自动启动
@@ -63,7 +160,7 @@ public:
     
     // 设置学习目标小时数
     // 参数1：学习目标小时数
-    void setTargetHour(int targetHour){m_studyTargetHour = targetHour;}
+    void setTargetHour(int targetHour);
     
     // 设置自动清理内存阈值
     // 参数1：内存阈值百分比
@@ -73,10 +170,14 @@ public:
     // 参数1：是否启用自动清理
     void setAutoCleanMemoryEnabled(bool enabled){m_isAutoCleanMemoryEnabled = enabled;}
     
-    // 设置最大连续天数
-    // 参数1：最大连续天数
-    void setMaxContinDays(int continDays){m_maxContinuousDays = continDays;}
-    
+    // 设置合并写入的时间窗口
+    // 参数1：毫秒数
+    void setSaveDebounceInterval(int ms);
+
+    // 获取合并写入的时间窗口
+    // 返回：毫秒数
+    int saveDebounceInterval(){return m_saveDebounceMs;}
+
     // 设置默认视图类型
     // 参数1：视图类型（0: 月视图, 1: 日视图）
     void setDefaultViewType(int viewType){m_defaultViewType = viewType;}
@@ -84,15 +185,27 @@ public:
     // 获取默认视图类型
     // 返回：视图类型（0: 月视图, 1: 日视图）
     int defaultViewType(){return m_defaultViewType;}
+
+    // 设置时间轴一格的分钟数
+    // 参数1：分钟数，只支持60、30、15
+    void setSlotMinutes(int minutes);
+
+    // 获取时间轴一格的分钟数
+    int slotMinutes() const {return m_slotMinutes;}
+
+    // 分钟数是否为支持的时间轴粒度
+    static bool isValidSlotMinutes(int minutes){return minutes == 60 || minutes == 30 || minutes == 15;}
     
-    // 重载[]运算符，用于访问指定日期的学习数据
+    // 重载[]运算符，用于访问指定日期的单日记录（按需从存档解码）
+    // 通过引用所做的修改会在下次读取统计时计入累计统计，但不更新连续天数索引，
+    // 编辑时间轴应使用setTimeAxisItem等接口
     // 参数1：日期键
-    // 返回：学习数据引用
-    DateStudyData& operator[](const QDate& key){return m_studyDataMap[key];}
+    // 返回：单日记录引用，可直接赋值为DateStudyData
+    DayRecord& operator[](const QDate& key);
 
 public:
     // 获取指定类型的路径
-    // 参数1：路径类型，支持"Root"、"Save"、"Config"、"Log"
+    // 参数1：路径类型，支持"Root"、"Save"、"Config"、"Log"、"Journal"、"Snapshot"、"Template"、"Category"
     // 返回：路径字符串
     const QString& path(QString type = "Root");
     
@@ -112,9 +225,15 @@ public:
     // 返回：学习目标小时数
     int targetHour(){return m_studyTargetHour;}
     
-    // 获取最大连续天数
+    // 获取最大连续天数，由连续天数索引计算
     // 返回：最大连续天数
-    int maxContinDays(){return m_maxContinuousDays;}
+    int maxContinDays() const {return m_streaks.longestStreak();}
+
+    // 获取连续天数索引，可查询任意日期所在的连续段与全部连续段
+    const StreakIndex& streaks() const {return m_streaks;}
+
+    // 获取按周、月、年的预先汇总，第一次读取时遍历历史建立，之后随每次修改增量更新
+    const StudyRollups& rollups() const;
     
     // 获取自动清理内存阈值
     // 返回：内存阈值百分比
@@ -124,27 +243,68 @@ public:
     // 返回：是否启用自动清理
     bool isAutoCleanMemoryEnabled(){return m_isAutoCleanMemoryEnabled;}
     
-    // 获取指定日期的学习数据
+    // 获取指定日期的学习数据（旧结构，时间轴按15分钟时段序号索引）
     // 参数1：日期键
     // 返回：学习数据
-    DateStudyData value(const QDate& key){return m_studyDataMap.value(key);}
+    DateStudyData value(const QDate& key){return m_studyStore.value(key);}
+
+    // 获取指定日期的单日记录，只读取统计字段时优先使用
+    // 参数1：日期键
+    // 返回：单日记录
+    DayRecord record(const QDate& key){return m_studyStore.record(key);}
+    
+    // 统计日期区间内的天数、学习时长、完成数与总数
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    // 返回：区间统计结果
+    StudyColumns::Totals totals(const QDate& from, const QDate& to) const {return m_studyStore.totals(from, to);}
+    
+    // 获取最早有数据的日期，没有数据时返回无效日期
+    QDate firstDate() const {return m_studyStore.firstDate();}
+    
+    // 获取最晚有数据的日期，没有数据时返回无效日期
+    QDate lastDate() const {return m_studyStore.lastDate();}
+    
+    // 按日期顺序遍历区间内日期的统计字段，不解码时段
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    // 参数3：访问者，形如 void(const QDate&, const DayRecord&)
+    template <typename Visitor>
+    void forEachSummary(const QDate& from, const QDate& to, Visitor visitor) const {m_studyStore.forEachSummary(from, to, visitor);}
+
+    // 按日期顺序遍历区间内有数据的日期的完整记录，耗时O(log n + k)，不拷贝记录
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    // 参数3：访问者，形如 void(const QDate&, const DayRecord&)，记录只在调用期间有效
+    template <typename Visitor>
+    void forEachInRange(const QDate& from, const QDate& to, Visitor visitor) const {m_studyStore.forEachInRange(from, to, visitor);}
+
+    // 获取日期区间上的有序游标，使用期间不得修改数据
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    StudyStore::Cursor range(const QDate& from, const QDate& to) const {return m_studyStore.range(from, to);}
     
     // 检查是否包含指定日期的数据
     // 参数1：日期键
     // 返回：是否包含
-    bool contains(const QDate& key){return m_studyDataMap.contains(key);}
+    bool contains(const QDate& key){return m_studyStore.contains(key);}
     
-    // 计算连续学习天数
+    // 计算连续学习天数，只计算学习时长大于零的日期，今天尚未学习时计算到昨天为止
     // 返回：连续学习天数
-    int calculateContinuousDays();
+    int calculateContinuousDays() const;
     
     // 创建数据备份
-    // 参数1：备份文件路径
+    // 参数1：备份文件路径，后缀为.json时导出为JSON，否则为二进制
     // 返回：是否成功
     bool createBackup(const QString& backupPath);
     
+    // 创建增量快照，只写入内容有变化的月份分块
+    // 参数1：输出，快照清单路径，可为nullptr
+    // 返回：是否成功
+    bool createSnapshot(QString* manifestPath = nullptr);
+    
     // 从备份恢复数据
-    // 参数1：备份文件路径
+    // 参数1：备份文件路径，自动识别二进制、JSON格式或快照清单
     // 返回：是否成功
     bool restoreFromBackup(const QString& backupPath);
     
@@ -153,8 +313,8 @@ public:
     int getTotalStudyDays() const;
     
     // 获取总学习时长（小时）
-    // 返回：总学习时长
-    int getTotalStudyHours() const;
+    // 返回：总学习时长，不足一小时的部分为小数
+    double getTotalStudyHours() const;
     
     // 获取平均每天学习时长（小时）
     // 返回：平均每天学习时长
@@ -172,20 +332,34 @@ public:
     // 返回：项目完成率
     double getProjectCompletionRate() const;
     
-    // 获取最近N天的学习数据
-    // 参数1：天数
-    // 返回：最近N天的学习数据，键为日期，值为学习数据
-    QMap<QDate, DateStudyData> getRecentStudyData(int days) const;
+    // 全量扫描校验累计统计，不一致时输出错误日志
+    // 返回：是否一致
+    bool verifyTotals() const;
+
+    // 设置是否在每次读取统计时都做全量校验（测试用）
+    // 参数1：是否校验
+    void setValidateTotals(bool enabled){m_validateTotals = enabled;}
 
 private:
     QString m_appDataPath;
     QString m_saveFilePath;
+    QString m_legacySaveFilePath;
     QString m_configFilePath;
     QString m_logDirectory;
+    QString m_journalFilePath;
+    QString m_snapshotDirectory;
+    QString m_templateFilePath;
+    QString m_categoryFilePath;
 
-    QMap<QDate, DateStudyData> m_studyDataMap;
+    // 学习历史存储，存档以内存映射打开并按天懒解码
+    StudyStore m_studyStore;
     int m_studyTargetHour = 4;
-    int m_maxContinuousDays = 0;
+
+    // 连续天数索引，随每次修改增量更新
+    StreakIndex m_streaks;
+
+    // 按周、月、年的预先汇总，未建立时修改不做维护
+    mutable StudyRollups m_rollups;
 
     QSettings *m_appSettings;
     bool m_isAutoStartup = false;
@@ -199,16 +373,73 @@ private:
     // 默认视图设置
     int m_defaultViewType = 0; // 0: 月视图, 1: 日视图
 
+    // 时间轴一格的分钟数
+    int m_slotMinutes = 60;
+
+    // 日程模板
+    DayTemplateStore m_templates;
+
+    // 事项类型，需要在读取存档之前加载
+    CategoryRegistry m_categories;
+
+    // 本次运行中最近一份增量快照的清单，之后的快照只重新编码修改过的月份
+    SnapshotStore::Manifest m_lastSnapshotManifest;
+    bool m_hasSnapshotManifest = false;
+
+    // 学习数据预写日志，累计超过阈值条记录后压缩回存档
+    StudyJournal m_journal;
+    int m_journalEntriesSinceSnapshot = 0;
+    bool m_storageOpened = false; // 是否已由openStorage()接管预写日志与存档
+    static const int kJournalCompactThreshold = 512;
+
+    // 累计统计，每次修改时增量更新，读取统计为O(1)
+    mutable StudyColumns::Totals m_totals;
+    mutable QSet<QDate> m_totalsPending; // 已扣除旧值、等待加回新值的日期
+    mutable bool m_validateTotals = false;
+
+    // 后台保存线程，未启动时同步写入
+    SaveWorker* m_saveWorker = nullptr;
+    quint64 m_snapshotSequence = 0;
+    int m_saveDebounceMs = 500;
+
 private:
-    // 保存每日日志
-    void saveLog();
-    
-    // 清理旧日志
-    void cleanupOldLogs();
-    
+    // 获取累计统计，先结算等待加回的日期
+    const StudyColumns::Totals& runningTotals() const;
+
+    // 从头重新计算累计统计（整体替换数据后调用）
+    void recomputeTotals();
+
+    // 从头重建连续天数索引（整体替换数据后调用）
+    void rebuildStreaks();
+
+    // 按当前类型属性重新计算全部记录的学习时长，并重建依赖学习时长的统计
+    void recountStudyMinutes();
+
+    // 整体快照的临时文件写入完成后替换存档
+    // 参数1：是否成功
+    // 参数2：快照序号
+    // 参数3：快照包含的修改序号
+    void onSnapshotWritten(bool ok, quint64 sequence, quint64 editSerial);
+
+    // 用写好的临时文件替换存档并重新映射
+    // 参数1：快照包含的修改序号，替换后只保留之后的编辑
+    // 返回：是否替换成功
+    bool installSnapshot(quint64 editSerial);
+
     // 从日志读取数据
     // 返回：是否成功
     bool loadDataFromLogs();
+
+    // 打开预写日志并重放其中尚未压缩的变更
+    void replayJournal();
+
+    // 将一条变更应用到内存数据
+    // 参数1：变更记录
+    void applyJournalEntry(const StudyJournal::Entry& entry);
+
+    // 应用变更并追加写入日志，必要时触发压缩
+    // 参数1：变更记录
+    void commitJournalEntry(const StudyJournal::Entry& entry);
 };
 
 extern AppDatas appDatas;
@@ -12,10 +12,10 @@ struct TimeAxisItem
 
 struct DateStudyData
 {
-    int studyHours = 0;
+    int studyMinutes = 0;
     int completedProjects = 0;
     int totalProjects = 0;
-    QMap<int, TimeAxisItem> timeAxisData;
+    QMap<int, TimeAxisItem> timeAxisData; // 按15分钟时段序号索引
 };
 
 #endif // DATASTRUCT_H
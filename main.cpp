@@ -2,6 +2,9 @@
 #include <QLocalServer>
 #include <QLocalSocket>
 #include "mainwindow.h"
+#include "appdatas.h"
+#include "utils/tracer.h"
+#include <QTimer>
 
 #define SERVER_NAME "PlanThrough_SingleInstance_Server"
 static MainWindow *g_mainWindow = nullptr;
@@ -15,10 +18,17 @@ int main(int argc, char *argv[])
         QApplication::setAttribute(Qt::AA_DontCreateNativeWidgetSiblings);
         QApplication::setAttribute(Qt::AA_EnableHighDpiScaling, false);
         QApplication::setAttribute(Qt::AA_UseHighDpiPixmaps, true);
+        Tracer::addInstant("main");
         QApplication a(argc, argv);
 
         qDebug() << "Application started";
 
+        // 带--trace参数启动时把启动各阶段的耗时写入日志目录，否则丢弃已记录的事件
+        const bool traceStartup = a.arguments().contains(Tracer::kCommandLineFlag);
+        if (!traceStartup) {
+            Tracer::disable();
+        }
+
         QLocalSocket socket;
         socket.connectToServer(SERVER_NAME);
         if(socket.waitForConnected(200))
@@ -42,16 +52,39 @@ int main(int argc, char *argv[])
         });
         server->listen(SERVER_NAME);
 
+        // 确认是唯一实例后才打开预写日志并启动后台保存线程，此前appDatas只读取存档
+        {
+            TraceScope trace("AppDatas::openStorage");
+            appDatas.openStorage();
+        }
+
         qDebug() << "Creating main window";
 
+        // 主窗口自行决定是否显示，开机自启时只显示托盘图标
+        const qint64 windowStartUs = Tracer::nowUs();
         MainWindow w;
         g_mainWindow = &w;
-        qDebug() << "Showing main window";
-        w.show();
+        Tracer::addComplete("MainWindow::MainWindow", windowStartUs, Tracer::nowUs() - windowStartUs);
+
+        // 事件循环处理完首次显示后写出追踪文件
+        if (traceStartup) {
+            QTimer::singleShot(0, &a, []() {
+                Tracer::addInstant("event loop idle");
+                const QString tracePath = Tracer::writeToDirectory(appDatas.path("Log"));
+                if (!tracePath.isEmpty()) {
+                    qDebug() << "启动追踪已写入：" << tracePath;
+                }
+                Tracer::disable();
+            });
+        }
 
         qDebug() << "Entering event loop";
 
-        return a.exec();
+        int ret = a.exec();
+
+        // 写出尚未落盘的编辑并停止后台保存线程
+        appDatas.stopSaveWorker();
+        return ret;
     } catch (const std::exception &e) {
         qCritical() << "Exception caught:" << e.what();
         return 1;
@@ -3,8 +3,11 @@
 #include "utils/widgetcontainer.h"
 #include "widgets/dayview.h"
 #include "widgets/monthview.h"
+#include "widgets/categorydialog.h"
+#include "widgets/yearview.h"
 #include "mainwindow.h"
 #include "appdatas.h"
+#include "utils/tracer.h"
 
 
 
@@ -18,15 +21,32 @@ MainWindow::MainWindow(QWidget *parent)
     this->setWindowIcon(QIcon(":/16.ico"));
     
     widgetContainer("main", this);
-    initUI();
-    applyTheme(appDatas.themeType());
     initSystemTray();
-    // 初始化日视图和月视图数据
-    findChild<DayView*>("dayView")->loadDateData(DateHelper::currentDate());
-    findChild<DayView*>("dayView")->updateDayViewStats();
-    findChild<MonthView*>("monthView")->generateMonthCalendar();
 
+    // 如果设置了开机自启，则只创建托盘图标，界面在第一次从托盘打开时再构建
+    if (appDatas.isAutoStartup()) {
+        qDebug() << "开机自启，仅创建托盘图标";
+        return;
+    }
 
+    ensureWindowBuilt();
+
+    // 强制窗口显示
+    this->showNormal();
+    this->raise();
+    this->activateWindow();
+}
+
+// 第一次显示窗口时构建界面，只创建默认视图
+void MainWindow::ensureWindowBuilt()
+{
+    if (m_mainStackedWidget) {
+        return;
+    }
+    TraceScope trace("MainWindow::ensureWindowBuilt");
+
+    initUI();
+    applyTheme(appDatas.themeType());
 
     // 根据用户设置显示默认视图
     if (appDatas.defaultViewType() == 0) {
@@ -35,11 +55,6 @@ MainWindow::MainWindow(QWidget *parent)
         switchToDayView();
     }
 
-    // 强制窗口显示
-    this->showNormal();
-    this->raise();
-    this->activateWindow();
-
     // 设置窗口最小大小
     this->setMinimumSize(400, 500);
     
@@ -48,11 +63,51 @@ MainWindow::MainWindow(QWidget *parent)
     int x = (screenGeometry.width() - this->width()) / 2;
     int y = (screenGeometry.height() - this->height()) / 2;
     this->move(x, y);
+}
 
-    // 如果设置了开机自启，则隐藏窗口
-    if (appDatas.isAutoStartup()) {
-        this->hide();
+// 获取指定页面的视图，第一次使用时创建并替换占位页面
+QWidget* MainWindow::ensureView(int index)
+{
+    QWidget* view = index == 0 ? static_cast<QWidget*>(m_dayView)
+                    : index == 1 ? static_cast<QWidget*>(m_monthView)
+                    : index == 2 ? static_cast<QWidget*>(m_yearView)
+                                 : static_cast<QWidget*>(m_statsView);
+    if (view) {
+        return view;
     }
+
+    static const char* const traceNames[] = {"MainWindow::ensureView(dayView)", "MainWindow::ensureView(monthView)",
+                                             "MainWindow::ensureView(yearView)", "MainWindow::ensureView(statsView)"};
+    TraceScope trace(traceNames[index]);
+    if (index == 0) {
+        m_dayView = new DayView(this);
+        m_dayView->loadDateData(DateHelper::currentDate());
+        m_dayView->updateDayViewStats();
+        view = m_dayView;
+    } else if (index == 1) {
+        m_monthView = new MonthView(this);
+        m_monthView->generateMonthCalendar();
+        view = m_monthView;
+    } else if (index == 2) {
+        // 年视图在显示时读取数据
+        m_yearView = new YearView(this);
+        view = m_yearView;
+    } else {
+        // 统计视图在显示时读取汇总，汇总在第一次读取时建立
+        m_statsView = new StatsView(this);
+        view = m_statsView;
+    }
+    qDebug() << "创建视图：" << view->objectName();
+
+    QWidget* placeholder = m_mainStackedWidget->widget(index);
+    const bool isCurrent = m_mainStackedWidget->currentIndex() == index;
+    m_mainStackedWidget->insertWidget(index, view);
+    m_mainStackedWidget->removeWidget(placeholder);
+    delete placeholder;
+    if (isCurrent) {
+        m_mainStackedWidget->setCurrentIndex(index);
+    }
+    return view;
 }
 
 // 析构函数，释放所有动态分配的资源
@@ -74,14 +129,18 @@ MainWindow::~MainWindow()
 // @param themeType 主题类型，0表示默认主题，1表示深色主题
 void MainWindow::applyTheme(int themeType)
 {
+    TraceScope trace("MainWindow::applyTheme");
     appDatas.setTheme(themeType);
     this->setStyleSheet(loadQss(themeType));
-    findChild<DayView*>("dayView")->updateDayViewStats();
+    if (m_dayView) {
+        m_dayView->updateDayViewStats();
+    }
 }
 
 // 初始化系统托盘
 void MainWindow::initSystemTray()
 {
+    TraceScope trace("MainWindow::initSystemTray");
     m_systemTrayIcon = new QSystemTrayIcon(this);
     m_systemTrayIcon->setIcon(QIcon(":/16.ico"));
     m_systemTrayIcon->setToolTip("学习计划打卡");
@@ -122,6 +181,7 @@ void MainWindow::onTrayIconClicked(QSystemTrayIcon::ActivationReason reason)
 // 从系统托盘显示窗口
 void MainWindow::showWindowFromTray()
 {
+    ensureWindowBuilt();
     this->show();
     this->activateWindow();
     this->raise();
@@ -130,118 +190,50 @@ void MainWindow::showWindowFromTray()
 // 切换到日视图
 void MainWindow::switchToDayView()
 {
-    if (m_isAnimating) {
-        return;
-    }
-    
-    if (m_mainStackedWidget->currentIndex() == 0) {
-        // 已经在日视图，确保按钮状态正确
-        m_dayViewBtn->setChecked(true);
-        m_monthViewBtn->setChecked(false);
-        findChild<DayView*>("dayView")->updateDayViewStats();
-        return;
-    }
-    
-    m_isAnimating = true;
-    
-    QWidget *currentWidget = m_mainStackedWidget->currentWidget();
-    if (!currentWidget) {
-        m_isAnimating = false;
-        return;
-    }
-    
-    QPoint originalPos = currentWidget->pos();
-    
-    // 创建退出动画 - 只执行一半（快→慢阶段）
-    QParallelAnimationGroup *exitGroup = new QParallelAnimationGroup(this);
-    
-    QPropertyAnimation *fadeOutAnim = new QPropertyAnimation(currentWidget, "windowOpacity");
-        fadeOutAnim->setDuration(250); // 总动画时长的一半
-        fadeOutAnim->setEasingCurve(QEasingCurve::InCubic); // 慢→快的缓动曲线
-        fadeOutAnim->setStartValue(1.0);
-        fadeOutAnim->setEndValue(0.5); // 只淡出到半透明
-        
-        QPropertyAnimation *slideOutAnim = new QPropertyAnimation(currentWidget, "pos");
-        slideOutAnim->setDuration(250);
-        slideOutAnim->setEasingCurve(QEasingCurve::InCubic); // 慢→快的缓动曲线
-        slideOutAnim->setStartValue(originalPos);
-        slideOutAnim->setEndValue(QPoint(originalPos.x() + 30, originalPos.y())); // 只滑动一半距离
-    
-    exitGroup->addAnimation(fadeOutAnim);
-    exitGroup->addAnimation(slideOutAnim);
-    
-    connect(exitGroup, &QParallelAnimationGroup::finished, this, [=]() {
-        // 在速度最快时（动画中点）切换页面
-        m_mainStackedWidget->setCurrentIndex(0);
-        
-        // 恢复当前控件状态
-        currentWidget->move(originalPos);
-        currentWidget->setWindowOpacity(1.0);
-        
-        QWidget *newWidget = m_mainStackedWidget->currentWidget();
-        if (!newWidget) {
-            m_isAnimating = false;
-            return;
-        }
-        
-        QPoint newOriginalPos = newWidget->pos();
-        
-        // 月视图→日视图：日视图从左滑入
-        QPoint newStartPos = newOriginalPos - QPoint(30, 0);
-        
-        newWidget->setWindowOpacity(0.5); // 从半透明开始
-        newWidget->move(newStartPos);
-        
-        // 执行进入动画的后半段（慢→快阶段）
-        QParallelAnimationGroup *enterGroup = new QParallelAnimationGroup(this);
-        
-        QPropertyAnimation *fadeInAnim = new QPropertyAnimation(newWidget, "windowOpacity");
-        fadeInAnim->setDuration(250);
-        fadeInAnim->setEasingCurve(QEasingCurve::OutCubic); // 快→慢的缓动曲线
-        fadeInAnim->setStartValue(0.5);
-        fadeInAnim->setEndValue(1.0);
-        
-        QPropertyAnimation *slideInAnim = new QPropertyAnimation(newWidget, "pos");
-        slideInAnim->setDuration(250);
-        slideInAnim->setEasingCurve(QEasingCurve::OutCubic); // 快→慢的缓动曲线
-        slideInAnim->setStartValue(newStartPos);
-        slideInAnim->setEndValue(newOriginalPos);
-        
-        enterGroup->addAnimation(fadeInAnim);
-        enterGroup->addAnimation(slideInAnim);
-        
-        connect(enterGroup, &QParallelAnimationGroup::finished, this, [=]() {
-            newWidget->move(newOriginalPos);
-            newWidget->setWindowOpacity(1.0);
-            
-            // 最终保障：强制设置正确的按钮状态
-            // 日视图显示 → 日视图按钮必须为checked，月视图按钮必须为unchecked
-            m_dayViewBtn->setChecked(true);
-            m_monthViewBtn->setChecked(false);
-            findChild<DayView*>("dayView")->updateDayViewStats();
-            
-            m_isAnimating = false;
-        });
-        
-        enterGroup->start(QAbstractAnimation::DeleteWhenStopped);
-        exitGroup->deleteLater();
-    });
-    
-    exitGroup->start(QAbstractAnimation::DeleteWhenStopped);
+    // 日视图由AppDatas的变化信号维持最新，切换时无需刷新
+    switchToPage(0);
 }
 
 // 切换到月视图
 void MainWindow::switchToMonthView()
+{
+    // 日视图中可能选择了其他日期，月历跟随到该日期所在月份
+    switchToPage(1, [=]() {
+        m_monthView->generateMonthCalendar();
+    });
+}
+
+// 切换到年视图
+void MainWindow::switchToYearView()
+{
+    // 年视图在显示时按需重新读取
+    switchToPage(2);
+}
+
+// 切换到统计视图
+void MainWindow::switchToStatsView()
+{
+    // 统计视图在显示时按需重新读取
+    switchToPage(3);
+}
+
+// 以滑动淡入淡出动画切换页面
+// 目标页序号大于当前页时新页面从右滑入，否则从左滑入
+void MainWindow::switchToPage(int index, const std::function<void()>& refresh)
 {
     if (m_isAnimating) {
         return;
     }
+
+    // 目标视图尚未创建时先创建
+    ensureView(index);
     
-    if (m_mainStackedWidget->currentIndex() == 1) {
-        // 已经在月视图，确保按钮状态正确
-        m_monthViewBtn->setChecked(true);
-        m_dayViewBtn->setChecked(false);
-        findChild<MonthView*>("monthView")->generateMonthCalendar();
+    if (m_mainStackedWidget->currentIndex() == index) {
+        // 已经在目标视图，确保按钮状态正确
+        updateViewButtons(index);
+        if (refresh) {
+            refresh();
+        }
         return;
     }
     
@@ -254,28 +246,29 @@ void MainWindow::switchToMonthView()
     }
     
     QPoint originalPos = currentWidget->pos();
+    const int slideOffset = index > m_mainStackedWidget->currentIndex() ? 30 : -30;
     
     // 创建退出动画 - 只执行一半（快→慢阶段）
     QParallelAnimationGroup *exitGroup = new QParallelAnimationGroup(this);
     
     QPropertyAnimation *fadeOutAnim = new QPropertyAnimation(currentWidget, "windowOpacity");
-        fadeOutAnim->setDuration(250); // 总动画时长的一半
-        fadeOutAnim->setEasingCurve(QEasingCurve::InCubic); // 慢→快的缓动曲线
-        fadeOutAnim->setStartValue(1.0);
-        fadeOutAnim->setEndValue(0.5); // 只淡出到半透明
-        
-        QPropertyAnimation *slideOutAnim = new QPropertyAnimation(currentWidget, "pos");
-        slideOutAnim->setDuration(250);
-        slideOutAnim->setEasingCurve(QEasingCurve::InCubic); // 慢→快的缓动曲线
-        slideOutAnim->setStartValue(originalPos);
-        slideOutAnim->setEndValue(QPoint(originalPos.x() - 30, originalPos.y())); // 只滑动一半距离
+    fadeOutAnim->setDuration(250); // 总动画时长的一半
+    fadeOutAnim->setEasingCurve(QEasingCurve::InCubic); // 慢→快的缓动曲线
+    fadeOutAnim->setStartValue(1.0);
+    fadeOutAnim->setEndValue(0.5); // 只淡出到半透明
+    
+    QPropertyAnimation *slideOutAnim = new QPropertyAnimation(currentWidget, "pos");
+    slideOutAnim->setDuration(250);
+    slideOutAnim->setEasingCurve(QEasingCurve::InCubic); // 慢→快的缓动曲线
+    slideOutAnim->setStartValue(originalPos);
+    slideOutAnim->setEndValue(QPoint(originalPos.x() - slideOffset, originalPos.y())); // 只滑动一半距离
     
     exitGroup->addAnimation(fadeOutAnim);
     exitGroup->addAnimation(slideOutAnim);
     
     connect(exitGroup, &QParallelAnimationGroup::finished, this, [=]() {
         // 在速度最快时（动画中点）切换页面
-        m_mainStackedWidget->setCurrentIndex(1);
+        m_mainStackedWidget->setCurrentIndex(index);
         
         // 恢复当前控件状态
         currentWidget->move(originalPos);
@@ -288,9 +281,7 @@ void MainWindow::switchToMonthView()
         }
         
         QPoint newOriginalPos = newWidget->pos();
-        
-        // 日视图→月视图：月视图从右滑入
-        QPoint newStartPos = newOriginalPos + QPoint(30, 0);
+        QPoint newStartPos = newOriginalPos + QPoint(slideOffset, 0);
         
         newWidget->setWindowOpacity(0.5); // 从半透明开始
         newWidget->move(newStartPos);
@@ -318,10 +309,10 @@ void MainWindow::switchToMonthView()
             newWidget->setWindowOpacity(1.0);
             
             // 最终保障：强制设置正确的按钮状态
-            // 月视图显示 → 月视图按钮必须为checked，日视图按钮必须为unchecked
-            m_monthViewBtn->setChecked(true);
-            m_dayViewBtn->setChecked(false);
-            findChild<MonthView*>("monthView")->generateMonthCalendar();
+            updateViewButtons(index);
+            if (refresh) {
+                refresh();
+            }
             
             m_isAnimating = false;
         });
@@ -333,12 +324,21 @@ void MainWindow::switchToMonthView()
     exitGroup->start(QAbstractAnimation::DeleteWhenStopped);
 }
 
+// 按当前页面设置视图按钮的选中状态，只有当前页面的按钮为checked
+void MainWindow::updateViewButtons(int index)
+{
+    m_dayViewBtn->setChecked(index == 0);
+    m_monthViewBtn->setChecked(index == 1);
+    m_yearViewBtn->setChecked(index == 2);
+    m_statsViewBtn->setChecked(index == 3);
+}
+
 // 显示设置窗口
 void MainWindow::showSettingsWindow()
 {
     QDialog *settingsDlg = new QDialog(this);
     settingsDlg->setWindowTitle("软件设置");
-    settingsDlg->setFixedSize(350, 300);
+    settingsDlg->setFixedSize(350, 340);
     settingsDlg->setModal(true);
     
     // 禁用所有可能的窗口动画效果
@@ -407,6 +407,33 @@ void MainWindow::showSettingsWindow()
         appDatas.setDefaultViewType(index);
     });
 
+    // 时间轴粒度设置
+    QHBoxLayout *slotMinutesLayout = new QHBoxLayout;
+    QLabel *slotMinutesLab = new QLabel("时间轴粒度：");
+    QComboBox *slotMinutesCbx = new QComboBox;
+    const QList<int> slotMinutesOptions = {60, 30, 15};
+    for (int minutes : slotMinutesOptions) {
+        slotMinutesCbx->addItem(QString("%1分钟").arg(minutes), minutes);
+    }
+    slotMinutesCbx->setCurrentIndex(slotMinutesOptions.indexOf(appDatas.slotMinutes()));
+    slotMinutesLayout->addWidget(slotMinutesLab);
+    slotMinutesLayout->addWidget(slotMinutesCbx);
+    slotMinutesLayout->addStretch();
+    connect(slotMinutesCbx, &QComboBox::currentIndexChanged, [=](int index) {
+        appDatas.setSlotMinutes(slotMinutesCbx->itemData(index).toInt());
+    });
+
+    // 事项类型管理
+    QHBoxLayout *categoryLayout = new QHBoxLayout;
+    QPushButton *categoryBtn = new QPushButton("管理事项类型");
+    categoryBtn->setStyleSheet("background-color:#2D8CF0;");
+    categoryLayout->addWidget(categoryBtn);
+    categoryLayout->addStretch();
+    connect(categoryBtn, &QPushButton::clicked, [=]() {
+        CategoryDialog categoryDlg(settingsDlg);
+        categoryDlg.exec();
+    });
+
     // 打开存档文件位置
     QHBoxLayout *pathLayout = new QHBoxLayout;
     QPushButton *pathBtn = new QPushButton("打开存档文件位置");
@@ -435,18 +462,22 @@ void MainWindow::showSettingsWindow()
     QHBoxLayout *backupLayout = new QHBoxLayout;
     QPushButton *createBackupBtn = new QPushButton("创建数据备份");
     createBackupBtn->setStyleSheet("background-color:#34B7F1;");
+    QPushButton *createSnapshotBtn = new QPushButton("创建增量快照");
+    createSnapshotBtn->setStyleSheet("background-color:#34B7F1;");
     QPushButton *restoreBackupBtn = new QPushButton("从备份恢复");
     restoreBackupBtn->setStyleSheet("background-color:#9370DB;");
 
     backupLayout->addWidget(createBackupBtn);
+    backupLayout->addWidget(createSnapshotBtn);
     backupLayout->addWidget(restoreBackupBtn);
     backupLayout->addStretch();
 
     // 连接备份和恢复按钮的信号槽
     connect(createBackupBtn, &QPushButton::clicked, [=]() {
         // 获取当前日期时间作为备份文件名
-        QString backupFileName = "study_data_backup_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".json";
-        QString backupPath = QFileDialog::getSaveFileName(settingsDlg, "保存数据备份", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/" + backupFileName, "JSON Files (*.json)");
+        // 默认保存为二进制备份，选择.json时导出为JSON
+        QString backupFileName = "study_data_backup_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".ptb";
+        QString backupPath = QFileDialog::getSaveFileName(settingsDlg, "保存数据备份", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/" + backupFileName, "Plan_through Backup (*.ptb);;JSON Files (*.json)");
 
         if (!backupPath.isEmpty()) {
             if (appDatas.createBackup(backupPath)) {
@@ -457,8 +488,18 @@ void MainWindow::showSettingsWindow()
         }
     });
 
+    // 增量快照保存在应用数据目录下，只写入有变化的月份
+    connect(createSnapshotBtn, &QPushButton::clicked, [=]() {
+        QString manifestPath;
+        if (appDatas.createSnapshot(&manifestPath)) {
+            QMessageBox::information(settingsDlg, "成功", "增量快照创建成功！\n" + manifestPath);
+        } else {
+            QMessageBox::critical(settingsDlg, "失败", "增量快照创建失败！");
+        }
+    });
+
     connect(restoreBackupBtn, &QPushButton::clicked, [=]() {
-        QString backupPath = QFileDialog::getOpenFileName(settingsDlg, "选择数据备份文件", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation), "JSON Files (*.json)");
+        QString backupPath = QFileDialog::getOpenFileName(settingsDlg, "选择数据备份文件", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation), "Backup Files (*.ptb *.json *.ptm);;Plan_through Backup (*.ptb);;JSON Files (*.json);;Snapshot Manifest (*.ptm)");
 
         if (!backupPath.isEmpty()) {
             QMessageBox::StandardButton reply;
@@ -482,6 +523,8 @@ void MainWindow::showSettingsWindow()
     mainLayout->addLayout(minTrayLayout);
     mainLayout->addLayout(themeLayout);
     mainLayout->addLayout(defaultViewLayout);
+    mainLayout->addLayout(slotMinutesLayout);
+    mainLayout->addLayout(categoryLayout);
     mainLayout->addLayout(pathLayout);
     mainLayout->addLayout(logLayout);
     mainLayout->addLayout(backupLayout);
@@ -654,6 +697,7 @@ bool MainWindow::event(QEvent *event)
 // 初始化用户界面
 void MainWindow::initUI()
 {
+    TraceScope trace("MainWindow::initUI");
     this->setMouseTracking(true); // 启用鼠标跟踪，确保鼠标移动时触发mouseMoveEvent
 
     QWidget* centralWidget = new QWidget(this);
@@ -666,6 +710,8 @@ void MainWindow::initUI()
     QHBoxLayout* topTabLayout = new QHBoxLayout;
     m_dayViewBtn = new QPushButton("日视图");
     m_monthViewBtn = new QPushButton("月视图");
+    m_yearViewBtn = new QPushButton("年视图");
+    m_statsViewBtn = new QPushButton("统计");
     m_settingsBtn = new QPushButton("设置");
     
     // 自定义最小化和关闭按钮
@@ -688,6 +734,8 @@ void MainWindow::initUI()
     
     m_dayViewBtn->setStyleSheet(topBtnStyle);
     m_monthViewBtn->setStyleSheet(topBtnStyle);
+    m_yearViewBtn->setStyleSheet(topBtnStyle);
+    m_statsViewBtn->setStyleSheet(topBtnStyle);
     m_settingsBtn->setStyleSheet(settingBtnStyle);
     m_minimizeBtn->setStyleSheet(windowBtnStyle);
     m_closeBtn->setStyleSheet(windowBtnStyle);
@@ -695,6 +743,8 @@ void MainWindow::initUI()
     // 设置按钮为可检查状态
     m_dayViewBtn->setCheckable(true);
     m_monthViewBtn->setCheckable(true);
+    m_yearViewBtn->setCheckable(true);
+    m_statsViewBtn->setCheckable(true);
     m_dayViewBtn->setChecked(true);
 
     // 连接按钮信号槽
@@ -709,6 +759,8 @@ void MainWindow::initUI()
 
     topTabLayout->addWidget(m_dayViewBtn);
     topTabLayout->addWidget(m_monthViewBtn);
+    topTabLayout->addWidget(m_yearViewBtn);
+    topTabLayout->addWidget(m_statsViewBtn);
     topTabLayout->addStretch();
     topTabLayout->addWidget(m_settingsBtn);
     topTabLayout->addWidget(m_minimizeBtn);
@@ -717,50 +769,42 @@ void MainWindow::initUI()
     mainLayout->addLayout(topTabLayout);
     connect(m_settingsBtn, &QPushButton::clicked, this, &MainWindow::showSettingsWindow);
 
-    // 堆叠窗口，用于切换日视图和月视图
+    // 堆叠窗口，用于切换日视图、月视图、年视图和统计视图
+    // 各页面先放置空白占位，视图在第一次切换到该页面时由ensureView创建
     m_mainStackedWidget = new QStackedWidget;
-    m_dayView = new DayView(this);
-    m_monthView = new MonthView(this);
-    m_mainStackedWidget->addWidget(m_dayView);
-    m_mainStackedWidget->addWidget(m_monthView);
+    for (int i = 0; i < 4; ++i) {
+        m_mainStackedWidget->addWidget(new QWidget);
+    }
     mainLayout->addWidget(m_mainStackedWidget);
 
     // 连接视图切换按钮的信号槽
-    // 彻底修复：完全控制按钮状态，禁止自动切换
+    // 只有在动画允许时才执行切换，动画进行时保持当前页面对应的按钮状态
     connect(m_dayViewBtn, &QPushButton::clicked, this, [=]() {
-        // 1. 首先阻止按钮的自动checked状态变化
-        // 2. 只有在动画允许时才执行切换
         if (!m_isAnimating) {
             switchToDayView();
         } else {
-            // 动画进行时，保持当前正确的状态
-            if (m_mainStackedWidget->currentIndex() == 0) {
-                // 当前是日视图，保持日视图按钮为checked
-                m_dayViewBtn->setChecked(true);
-                m_monthViewBtn->setChecked(false);
-            } else {
-                // 当前是月视图，保持月视图按钮为checked
-                m_monthViewBtn->setChecked(true);
-                m_dayViewBtn->setChecked(false);
-            }
+            updateViewButtons(m_mainStackedWidget->currentIndex());
         }
     });
     connect(m_monthViewBtn, &QPushButton::clicked, this, [=]() {
-        // 1. 首先阻止按钮的自动checked状态变化
-        // 2. 只有在动画允许时才执行切换
         if (!m_isAnimating) {
             switchToMonthView();
         } else {
-            // 动画进行时，保持当前正确的状态
-            if (m_mainStackedWidget->currentIndex() == 1) {
-                // 当前是月视图，保持月视图按钮为checked
-                m_monthViewBtn->setChecked(true);
-                m_dayViewBtn->setChecked(false);
-            } else {
-                // 当前是日视图，保持日视图按钮为checked
-                m_dayViewBtn->setChecked(true);
-                m_monthViewBtn->setChecked(false);
-            }
+            updateViewButtons(m_mainStackedWidget->currentIndex());
+        }
+    });
+    connect(m_yearViewBtn, &QPushButton::clicked, this, [=]() {
+        if (!m_isAnimating) {
+            switchToYearView();
+        } else {
+            updateViewButtons(m_mainStackedWidget->currentIndex());
+        }
+    });
+    connect(m_statsViewBtn, &QPushButton::clicked, this, [=]() {
+        if (!m_isAnimating) {
+            switchToStatsView();
+        } else {
+            updateViewButtons(m_mainStackedWidget->currentIndex());
         }
     });
     
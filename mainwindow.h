@@ -46,6 +46,9 @@
 #include <QMouseEvent>
 #include "widgets/dayview.h"
 #include "widgets/monthview.h"
+#include "widgets/yearview.h"
+#include "widgets/statsview.h"
+#include <functional>
 
 class MainWindow : public QMainWindow
 {
@@ -75,6 +78,12 @@ private slots:
     // 切换到月视图
     void switchToMonthView();
     
+    // 切换到年视图
+    void switchToYearView();
+
+    // 切换到统计视图
+    void switchToStatsView();
+    
     // 显示设置窗口
     void showSettingsWindow();
     
@@ -126,15 +135,34 @@ protected:
 private:
     // 初始化用户界面
     void initUI();
+
+    // 第一次显示窗口时构建界面，开机自启时推迟到从托盘打开窗口
+    void ensureWindowBuilt();
+
+    // 获取指定页面的视图，第一次使用时创建
+    // 参数1：页面序号（0: 日视图, 1: 月视图, 2: 年视图, 3: 统计视图）
+    // 返回：视图
+    QWidget* ensureView(int index);
     
     // 初始化系统托盘
     void initSystemTray();
     
+    // 以动画切换到指定页面
+    // 参数1：页面序号
+    // 参数2：切换完成后执行的刷新，可为空
+    void switchToPage(int index, const std::function<void()>& refresh = {});
+    
+    // 按当前页面设置视图按钮的选中状态
+    // 参数1：页面序号
+    void updateViewButtons(int index);
+    
 
 
 private:
     QPushButton *m_dayViewBtn = nullptr;
     QPushButton *m_monthViewBtn = nullptr;
+    QPushButton *m_yearViewBtn = nullptr;
+    QPushButton *m_statsViewBtn = nullptr;
     QPushButton *m_settingsBtn = nullptr;
     QPushButton *m_minimizeBtn = nullptr;
     QPushButton *m_closeBtn = nullptr;
@@ -143,8 +171,11 @@ private:
     QSystemTrayIcon *m_systemTrayIcon = nullptr;
     QMenu *m_trayMenu = nullptr;
 
+    // 各视图在第一次使用时创建，之前为空
     DayView* m_dayView = nullptr;
     MonthView* m_monthView = nullptr;
+    YearView* m_yearView = nullptr;
+    StatsView* m_statsView = nullptr;
     
     // 用于防止连点的标志
     bool m_isAnimating = false;
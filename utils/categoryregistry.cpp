@@ -0,0 +1,122 @@
+#include "categoryregistry.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QDebug>
+
+// 从文件加载类型并注册到CategoryTable
+bool CategoryRegistry::load(const QString& path)
+{
+    m_path = path;
+
+    QFile file(path);
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "无法打开类型文件进行读取：" << path << "，错误：" << file.errorString();
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCritical() << "类型文件解析失败：" << path << "，错误：" << error.errorString();
+        return false;
+    }
+
+    const QJsonArray categories = doc.object().value("categories").toArray();
+    for (const QJsonValue& value : categories) {
+        const QJsonObject obj = value.toObject();
+        CategoryTable::Category category;
+        category.name = obj.value("name").toString();
+        if (category.name.isEmpty()) {
+            continue;
+        }
+        const quint8 id = CategoryTable::idOf(category.name);
+        if (id == CategoryTable::kInvalid) {
+            continue;
+        }
+        const CategoryTable::Category current = CategoryTable::info(id);
+        category.color = obj.contains("color") ? QColor(obj.value("color").toString()) : current.color;
+        category.background = obj.contains("background") ? QColor(obj.value("background").toString()) : current.background;
+        category.countsAsStudy = obj.value("countsAsStudy").toBool(current.countsAsStudy);
+        category.targetMinutes = obj.value("targetMinutes").toInt(current.targetMinutes);
+        if (!category.color.isValid()) {
+            category.color = current.color;
+        }
+        CategoryTable::setInfo(id, category);
+    }
+    qDebug() << "加载" << CategoryTable::count() << "种事项类型";
+    return true;
+}
+
+// 获取全部类型
+QList<CategoryTable::Category> CategoryRegistry::categories() const
+{
+    QList<CategoryTable::Category> categories;
+    const int count = CategoryTable::count();
+    for (int id = 0; id < count; ++id) {
+        categories.append(CategoryTable::info(quint8(id)));
+    }
+    return categories;
+}
+
+// 批量修改类型的属性并新增类型，全部修改完成后只写入一次文件
+bool CategoryRegistry::update(const QList<CategoryTable::Category>& categories)
+{
+    const int existingCount = CategoryTable::count();
+    bool studyChanged = false;
+    for (int i = 0; i < categories.size(); ++i) {
+        quint8 id = quint8(i);
+        if (i >= existingCount) {
+            // 已存在同名类型时只更新属性
+            const QString name = categories[i].name.trimmed();
+            id = name.isEmpty() ? CategoryTable::kInvalid : CategoryTable::idOf(name);
+            if (id == CategoryTable::kInvalid) {
+                qWarning() << "无法新增事项类型：" << categories[i].name;
+                continue;
+            }
+        }
+        if (CategoryTable::setInfo(id, categories[i])) {
+            studyChanged = true;
+        }
+    }
+    save();
+    return studyChanged;
+}
+
+// 把全部类型按编号顺序写入文件
+bool CategoryRegistry::save() const
+{
+    if (m_path.isEmpty()) {
+        return false;
+    }
+
+    QJsonArray categories;
+    for (const CategoryTable::Category& category : this->categories()) {
+        QJsonObject obj;
+        obj.insert("name", category.name);
+        obj.insert("color", category.color.name());
+        obj.insert("background", category.background.name());
+        obj.insert("countsAsStudy", category.countsAsStudy);
+        obj.insert("targetMinutes", category.targetMinutes);
+        categories.append(obj);
+    }
+    QJsonObject rootObj;
+    rootObj.insert("categories", categories);
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "无法打开类型文件进行写入：" << m_path << "，错误：" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(rootObj).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        qCritical() << "类型文件写入失败：" << m_path << "，错误：" << file.errorString();
+        return false;
+    }
+    return true;
+}
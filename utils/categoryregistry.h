@@ -0,0 +1,38 @@
+#ifndef CATEGORYREGISTRY_H
+#define CATEGORYREGISTRY_H
+
+#include <QString>
+#include <QList>
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The CategoryRegistry class
+ * 事项类型的持久化，把CategoryTable中全部类型的名称与属性保存为JSON文件。
+ * 加载时按文件中的顺序注册，编号与上次运行保持一致，因此需要在读取存档之前加载；
+ * 类型只能新增、不能删除，已有记录与模板中的类型名称始终可以解析。
+ */
+class CategoryRegistry
+{
+public:
+    // 从文件加载类型并注册到CategoryTable，文件不存在时只有内置类型
+    // 参数1：类型文件路径
+    // 返回：是否成功，文件不存在也视为成功
+    bool load(const QString& path);
+
+    // 获取全部类型，下标即编号
+    QList<CategoryTable::Category> categories() const;
+
+    // 批量修改类型的属性并新增类型，全部修改完成后只写入一次文件
+    // 参数1：按编号排列的类型，下标小于现有类型数的按编号修改（名称被忽略），其余按名称新增
+    // 返回：是否有类型的“计入学习时长”发生了变化
+    bool update(const QList<CategoryTable::Category>& categories);
+
+private:
+    // 把全部类型写入文件
+    bool save() const;
+
+private:
+    QString m_path;
+};
+
+#endif // CATEGORYREGISTRY_H
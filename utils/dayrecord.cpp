@@ -0,0 +1,350 @@
+#include "dayrecord.h"
+#include <QHash>
+#include <QReadWriteLock>
+#include <QAtomicInteger>
+#include <QDebug>
+#include <QVector>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+// 内置类型的默认配色，下标即编号，依次为文字颜色与背景色
+const char* const kBuiltinColors[][2] = {
+    {"#2D8CF0", "#ECF5FF"},
+    {"#2E7D32", "#E8F5E9"},
+    {"#6A1B9A", "#F3E5F5"},
+    {"#006064", "#E0F7FA"},
+    {"#C62828", "#FFEBEE"},
+    {"#E65100", "#FFF8E1"},
+};
+
+// 类型字典的全局状态，读多写少
+struct CategoryState
+{
+    QReadWriteLock lock;
+    QStringList names = CategoryTable::builtinNames();
+    QHash<QString, quint8> ids;
+    QVector<CategoryTable::Category> infos;
+    QAtomicInteger<quint64> studyMask[4]; // 第id位为1表示计入学习时长
+
+    CategoryState()
+    {
+        for (int i = 0; i < names.size(); ++i) {
+            ids.insert(names[i], quint8(i));
+            infos.append(defaultInfo(names[i], i));
+        }
+        studyMask[0].storeRelaxed(quint64(1) << CategoryTable::kStudy);
+        infos[CategoryTable::kStudy].countsAsStudy = true;
+    }
+
+    // 新类型的默认属性，内置类型沿用原有配色，其余按编号取不同色相
+    static CategoryTable::Category defaultInfo(const QString& name, int id)
+    {
+        CategoryTable::Category category;
+        category.name = name;
+        if (id < int(std::size(kBuiltinColors))) {
+            category.color = QColor(kBuiltinColors[id][0]);
+            category.background = QColor(kBuiltinColors[id][1]);
+        } else {
+            category.color = QColor::fromHsv(id * 47 % 360, 200, 170);
+            category.background = CategoryTable::backgroundFor(category.color);
+        }
+        return category;
+    }
+};
+
+CategoryState& categoryState()
+{
+    static CategoryState state;
+    return state;
+}
+}
+
+// 内置事项类型
+const QStringList& CategoryTable::builtinNames()
+{
+    static const QStringList types = {"学习", "吃饭", "睡觉", "洗澡", "游戏", "杂事"};
+    return types;
+}
+
+// 获取类型编号，不存在时追加
+quint8 CategoryTable::idOf(const QString& name)
+{
+    const quint8 id = find(name);
+    if (id != kInvalid) {
+        return id;
+    }
+
+    CategoryState& state = categoryState();
+    QWriteLocker locker(&state.lock);
+    auto it = state.ids.constFind(name);
+    if (it != state.ids.constEnd()) {
+        return it.value();
+    }
+    if (state.names.size() >= kInvalid) {
+        qWarning() << "事项类型超过" << int(kInvalid) << "种，忽略类型：" << name;
+        return kInvalid;
+    }
+    const quint8 newId = quint8(state.names.size());
+    state.names.append(name);
+    state.ids.insert(name, newId);
+    state.infos.append(CategoryState::defaultInfo(name, newId));
+    return newId;
+}
+
+// 查找类型编号，不追加
+quint8 CategoryTable::find(const QString& name)
+{
+    CategoryState& state = categoryState();
+    QReadLocker locker(&state.lock);
+    return state.ids.value(name, kInvalid);
+}
+
+// 获取类型名称
+QString CategoryTable::nameOf(quint8 id)
+{
+    CategoryState& state = categoryState();
+    QReadLocker locker(&state.lock);
+    return id < state.names.size() ? state.names[id] : QString();
+}
+
+// 获取全部类型名称
+QStringList CategoryTable::names()
+{
+    CategoryState& state = categoryState();
+    QReadLocker locker(&state.lock);
+    return state.names;
+}
+
+// 获取类型数
+int CategoryTable::count()
+{
+    CategoryState& state = categoryState();
+    QReadLocker locker(&state.lock);
+    return state.names.size();
+}
+
+// 获取类型的属性
+CategoryTable::Category CategoryTable::info(quint8 id)
+{
+    CategoryState& state = categoryState();
+    QReadLocker locker(&state.lock);
+    return id < state.infos.size() ? state.infos[id] : Category();
+}
+
+// 设置类型的配色、是否计入学习时长与每日目标
+bool CategoryTable::setInfo(quint8 id, const Category& category)
+{
+    CategoryState& state = categoryState();
+    QWriteLocker locker(&state.lock);
+    if (id >= state.infos.size()) {
+        return false;
+    }
+    Category& info = state.infos[id];
+    const bool studyChanged = info.countsAsStudy != category.countsAsStudy;
+    info.color = category.color;
+    info.background = category.background.isValid() ? category.background : backgroundFor(category.color);
+    info.countsAsStudy = category.countsAsStudy;
+    info.targetMinutes = qMax(0, category.targetMinutes);
+    if (studyChanged) {
+        const quint64 bit = quint64(1) << (id % 64);
+        if (category.countsAsStudy) {
+            state.studyMask[id / 64].fetchAndOrRelaxed(bit);
+        } else {
+            state.studyMask[id / 64].fetchAndAndRelaxed(~bit);
+        }
+    }
+    return studyChanged;
+}
+
+// 是否计入学习时长
+bool CategoryTable::countsAsStudy(quint8 id)
+{
+    return (categoryState().studyMask[id / 64].loadRelaxed() >> (id % 64)) & 1;
+}
+
+// 由文字颜色生成同色调的浅色背景，与内置类型的背景明度相近
+QColor CategoryTable::backgroundFor(const QColor& color)
+{
+    return QColor::fromHsl(color.hslHue(), qMin(color.hslSaturation(), 160), 240);
+}
+
+DayRecord::DayRecord()
+{
+    std::fill(std::begin(categories), std::end(categories), kEmptySlot);
+}
+
+// 从旧的嵌套结构转换
+DayRecord::DayRecord(const DateStudyData& data)
+    : DayRecord()
+{
+    for (auto it = data.timeAxisData.constBegin(); it != data.timeAxisData.constEnd(); ++it) {
+        if (!setSlot(it.key(), CategoryTable::idOf(it->type), it->isCompleted)) {
+            qWarning() << "忽略无法转换的时段：" << it.key() << it->type;
+        }
+    }
+}
+
+// 转换为旧的嵌套结构
+DateStudyData DayRecord::toStudyData() const
+{
+    DateStudyData data;
+    data.studyMinutes = studyMinutes;
+    data.completedProjects = completedProjects;
+    data.totalProjects = totalProjects;
+    for (int slot = 0; slot < kSlotCount; ++slot) {
+        if (categories[slot] != kEmptySlot) {
+            data.timeAxisData.insert(slot, {CategoryTable::nameOf(categories[slot]), isCompleted(slot)});
+        }
+    }
+    return data;
+}
+
+// 获取时段开始的“时:分”文字
+QString DayRecord::slotLabel(int slot)
+{
+    const int minutes = slot * kSlotMinutes;
+    return QString("%1:%2").arg(minutes / 60).arg(minutes % 60, 2, 10, QChar('0'));
+}
+
+// 把分钟数格式化为小时数，整小时不带小数
+QString DayRecord::formatHours(int minutes)
+{
+    if (minutes % 60 == 0) {
+        return QString::number(minutes / 60);
+    }
+    QString text = QString::number(minutes / 60.0, 'f', 2);
+    while (text.endsWith('0')) {
+        text.chop(1);
+    }
+    return text;
+}
+
+// 获取某一类型已安排的时段数，超出计数范围的类型需要遍历时段
+int DayRecord::slotsOf(quint8 category) const
+{
+    if (category < kCountedCategories) {
+        return categorySlotCounts[category];
+    }
+    if (category == kEmptySlot || uncountedSlots == 0) {
+        return 0;
+    }
+    return int(std::count(std::begin(categories), std::end(categories), category));
+}
+
+// 指定时段是否为一个项目的开头
+// 项目不跨越整点，因此每小时的第一个时段只要已安排就是项目开头
+bool DayRecord::startsProject(int slot) const
+{
+    if (!hasSlot(slot)) {
+        return false;
+    }
+    if (slot % kSlotsPerHour == 0) {
+        return true;
+    }
+    return categories[slot - 1] != categories[slot] || isCompleted(slot - 1) != isCompleted(slot);
+}
+
+// 计入或扣除指定时段及其后一时段的项目数
+// 修改一个时段只会影响它自身与后一时段是否为项目开头
+void DayRecord::countProjects(int slot, int sign)
+{
+    for (int s = slot; s <= slot + 1 && s < kSlotCount; ++s) {
+        if (startsProject(s)) {
+            totalProjects += sign;
+            if (isCompleted(s)) {
+                completedProjects += sign;
+            }
+        }
+    }
+}
+
+// 设置指定时段的事项，并更新统计字段
+bool DayRecord::setSlot(int slot, quint8 category, bool completed)
+{
+    if (!isValidSlot(slot) || category == kEmptySlot) {
+        return false;
+    }
+    clearSlot(slot);
+
+    countProjects(slot, -1);
+    categories[slot] = category;
+    if (category < kCountedCategories) {
+        ++categorySlotCounts[category];
+    } else {
+        ++uncountedSlots;
+    }
+    if (completed) {
+        completedMask[slot / 64] |= quint64(1) << (slot % 64);
+        if (CategoryTable::countsAsStudy(category)) {
+            studyMinutes += kSlotMinutes;
+        }
+    }
+    countProjects(slot, 1);
+    return true;
+}
+
+// 设置连续若干时段的事项
+bool DayRecord::setSlots(int first, int count, quint8 category, bool completed)
+{
+    if (count <= 0 || !isValidSlot(first) || !isValidSlot(first + count - 1) || category == kEmptySlot) {
+        return false;
+    }
+    for (int slot = first; slot < first + count; ++slot) {
+        setSlot(slot, category, completed);
+    }
+    return true;
+}
+
+// 清除指定时段的事项，并更新统计字段
+void DayRecord::clearSlot(int slot)
+{
+    if (!hasSlot(slot)) {
+        return;
+    }
+
+    countProjects(slot, -1);
+    if (isCompleted(slot) && CategoryTable::countsAsStudy(categories[slot])) {
+        studyMinutes -= kSlotMinutes;
+    }
+    if (categories[slot] < kCountedCategories) {
+        --categorySlotCounts[categories[slot]];
+    } else {
+        --uncountedSlots;
+    }
+    categories[slot] = kEmptySlot;
+    completedMask[slot / 64] &= ~(quint64(1) << (slot % 64));
+    countProjects(slot, 1);
+}
+
+// 按当前的类型属性重新计算统计字段
+void DayRecord::recount()
+{
+    DayRecord recounted;
+    for (int slot = 0; slot < kSlotCount; ++slot) {
+        if (hasSlot(slot)) {
+            recounted.setSlot(slot, categories[slot], isCompleted(slot));
+        }
+    }
+    *this = recounted;
+}
+
+// 取消全部时段的完成状态
+void DayRecord::clearCompleted()
+{
+    DayRecord pending;
+    for (int slot = 0; slot < kSlotCount; ++slot) {
+        if (hasSlot(slot)) {
+            pending.setSlot(slot, categories[slot], false);
+        }
+    }
+    *this = pending;
+}
+
+// 清除连续若干时段的事项
+void DayRecord::clearSlots(int first, int count)
+{
+    for (int slot = qMax(0, first); slot < first + count && slot < kSlotCount; ++slot) {
+        clearSlot(slot);
+    }
+}
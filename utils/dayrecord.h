@@ -0,0 +1,192 @@
+#ifndef DAYRECORD_H
+#define DAYRECORD_H
+
+#include <QString>
+#include <QStringList>
+#include <QColor>
+#include "datastruct.h"
+
+/**
+ * @brief The CategoryTable class
+ * 事项类型字典，把类型字符串驻留为单字节编号，并保存每种类型的配色、是否计入学习时长与每日目标。
+ * 内置类型固定占据前几个编号（“学习”为0），新类型追加在后，编号一经分配不再改变；
+ * 名称是类型的标识，存档与模板中按名称保存，因此已有类型不能改名。
+ * 是否计入学习时长另存一份位掩码，修改时段时无需加锁即可查询。
+ * 可在任意线程调用。
+ */
+class CategoryTable
+{
+public:
+    // 类型的属性
+    struct Category
+    {
+        QString name;
+        QColor color;               // 文字颜色
+        QColor background;          // 背景色
+        bool countsAsStudy = false; // 是否计入学习时长
+        int targetMinutes = 0;      // 每日目标分钟数，0表示不设目标
+    };
+
+    // “学习”类型的编号
+    static constexpr quint8 kStudy = 0;
+
+    // 无效编号，同时表示空时段
+    static constexpr quint8 kInvalid = 0xFF;
+
+    // 获取类型编号，不存在时追加
+    // 参数1：类型名称
+    // 返回：类型编号，类型数已满时返回kInvalid
+    static quint8 idOf(const QString& name);
+
+    // 查找类型编号，不追加
+    // 参数1：类型名称
+    // 返回：类型编号，不存在时返回kInvalid
+    static quint8 find(const QString& name);
+
+    // 获取类型名称
+    // 参数1：类型编号
+    // 返回：类型名称，编号无效时返回空字符串
+    static QString nameOf(quint8 id);
+
+    // 获取全部类型名称，下标即编号
+    static QStringList names();
+
+    // 内置事项类型
+    static const QStringList& builtinNames();
+
+    // 获取类型数
+    static int count();
+
+    // 获取类型的属性
+    // 参数1：类型编号
+    // 返回：类型属性，编号无效时名称为空
+    static Category info(quint8 id);
+
+    // 设置类型的配色、是否计入学习时长与每日目标，名称保持不变
+    // 参数1：类型编号
+    // 参数2：类型属性
+    // 返回：是否计入学习时长是否发生了变化，变化后已有记录的学习时长需要重新计算
+    static bool setInfo(quint8 id, const Category& category);
+
+    // 是否计入学习时长，不加锁
+    // 参数1：类型编号
+    static bool countsAsStudy(quint8 id);
+
+    // 由文字颜色生成同色调的浅色背景
+    // 参数1：文字颜色
+    static QColor backgroundFor(const QColor& color);
+};
+
+/**
+ * @brief The DayRecord struct
+ * 紧凑的单日记录，定长且不含堆内存，约一百三十字节连续存放。
+ * 全天按15分钟划分为96个时段（时段序号 = 当日分钟数 / 15），每个时段用一个字节保存类型编号，
+ * 完成状态存放在位掩码中。时间轴以60/30/15分钟为一格显示时，一格对应连续的若干时段。
+ * 学习分钟数、完成数与总数随时段修改同步维护，读取统计时无需遍历时段；
+ * 编号小于kCountedCategories的类型另有逐类型的时段计数，同样随时段修改维护；
+ * 同一小时内相邻且类型与完成状态相同的时段计为一个项目，整小时安排的事项与旧版本计数一致。
+ */
+struct DayRecord
+{
+    static constexpr int kSlotMinutes = 15;                   // 单个时段的分钟数
+    static constexpr int kSlotsPerHour = 60 / kSlotMinutes;   // 每小时的时段数
+    static constexpr int kSlotCount = 24 * kSlotsPerHour;     // 全天时段数
+    static constexpr quint8 kEmptySlot = CategoryTable::kInvalid;
+    static constexpr int kCountedCategories = 16;             // 单独计数的类型数，编号更大的类型计入uncountedSlots
+
+    quint8 categories[kSlotCount];
+    quint64 completedMask[2] = {};
+    quint16 studyMinutes = 0;
+    quint8 completedProjects = 0;
+    quint8 totalProjects = 0;
+    quint8 categorySlotCounts[kCountedCategories] = {}; // 各类型已安排的时段数，下标为类型编号
+    quint8 uncountedSlots = 0;                          // 编号不小于kCountedCategories的时段数
+
+    DayRecord();
+
+    // 从旧的嵌套结构转换，超出时段范围的序号会被忽略
+    DayRecord(const DateStudyData& data);
+
+    // 转换为旧的嵌套结构，时间轴按时段序号索引
+    DateStudyData toStudyData() const;
+
+    // 时段序号是否有效
+    static bool isValidSlot(int slot){return slot >= 0 && slot < kSlotCount;}
+
+    // 获取某小时某分钟所在的时段序号
+    // 参数1：小时
+    // 参数2：分钟
+    static int slotOf(int hour, int minute = 0){return hour * kSlotsPerHour + minute / kSlotMinutes;}
+
+    // 获取时段开始的“时:分”文字
+    // 参数1：时段序号
+    static QString slotLabel(int slot);
+
+    // 把分钟数格式化为小时数，整小时不带小数
+    // 参数1：分钟数
+    static QString formatHours(int minutes);
+
+    // 指定时段是否已安排事项
+    bool hasSlot(int slot) const {return isValidSlot(slot) && categories[slot] != kEmptySlot;}
+
+    // 获取指定时段的类型编号，未安排时返回kEmptySlot
+    quint8 categoryAt(int slot) const {return isValidSlot(slot) ? categories[slot] : kEmptySlot;}
+
+    // 指定时段的事项是否已完成
+    bool isCompleted(int slot) const {return hasSlot(slot) && (completedMask[slot / 64] & (quint64(1) << (slot % 64)));}
+
+    // 获取某一类型已安排的时段数，编号在计数范围内时直接读取计数
+    // 参数1：类型编号
+    int slotsOf(quint8 category) const;
+
+    // 获取某一类型已安排的分钟数
+    // 参数1：类型编号
+    int minutesOf(quint8 category) const {return slotsOf(category) * kSlotMinutes;}
+
+    // 学习时长是否达到目标
+    // 参数1：目标小时数
+    bool reachesTarget(int targetHours) const {return studyMinutes >= targetHours * 60;}
+
+    // 设置指定时段的事项，并更新统计字段
+    // 参数1：时段序号
+    // 参数2：类型编号
+    // 参数3：是否完成
+    // 返回：时段序号或类型编号无效时返回false
+    bool setSlot(int slot, quint8 category, bool completed);
+
+    // 设置连续若干时段的事项
+    // 参数1：第一个时段序号
+    // 参数2：时段数
+    // 参数3：类型编号
+    // 参数4：是否完成
+    // 返回：任一时段无效时返回false，此时不做任何修改
+    bool setSlots(int first, int count, quint8 category, bool completed);
+
+    // 清除指定时段的事项，并更新统计字段
+    void clearSlot(int slot);
+
+    // 清除连续若干时段的事项
+    // 参数1：第一个时段序号
+    // 参数2：时段数
+    void clearSlots(int first, int count);
+
+    // 清空全部时段
+    void clear(){*this = DayRecord();}
+
+    // 取消全部时段的完成状态，时段安排保持不变，并更新统计字段
+    void clearCompleted();
+
+    // 按当前的类型属性重新计算统计字段，类型是否计入学习时长变化后调用
+    void recount();
+
+private:
+    // 指定时段是否为一个项目的开头，即与前一时段不属于同一项目
+    bool startsProject(int slot) const;
+
+    // 计入或扣除指定时段及其后一时段的项目数
+    // 参数1：时段序号
+    // 参数2：1为计入，-1为扣除
+    void countProjects(int slot, int sign);
+};
+
+#endif // DAYRECORD_H
@@ -0,0 +1,119 @@
+#include "daytemplatestore.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QDebug>
+
+// 从文件加载模板
+bool DayTemplateStore::load(const QString& path)
+{
+    m_path = path;
+    m_templates.clear();
+
+    QFile file(path);
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "无法打开模板文件进行读取：" << path << "，错误：" << file.errorString();
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCritical() << "模板文件解析失败：" << path << "，错误：" << error.errorString();
+        return false;
+    }
+
+    const QJsonArray templates = doc.object().value("templates").toArray();
+    for (const QJsonValue& value : templates) {
+        const QJsonObject obj = value.toObject();
+        const QString name = obj.value("name").toString();
+        if (name.isEmpty()) {
+            continue;
+        }
+        DayRecord record;
+        const QJsonArray items = obj.value("items").toArray();
+        for (const QJsonValue& itemValue : items) {
+            const QJsonObject item = itemValue.toObject();
+            const quint8 category = CategoryTable::idOf(item.value("type").toString());
+            if (!record.setSlots(item.value("slot").toInt(-1), item.value("count").toInt(), category, item.value("isCompleted").toBool())) {
+                qWarning() << "忽略模板中无效的时段：" << name << item;
+            }
+        }
+        // 旧版本保存的模板可能带有完成状态
+        record.clearCompleted();
+        m_templates.insert(name, record);
+    }
+    qDebug() << "加载" << m_templates.size() << "个日程模板";
+    return true;
+}
+
+// 保存模板，同名时覆盖
+bool DayTemplateStore::insert(const QString& name, const DayRecord& record)
+{
+    DayRecord pending = record;
+    pending.clearCompleted();
+    m_templates.insert(name, pending);
+    return save();
+}
+
+// 删除模板
+bool DayTemplateStore::remove(const QString& name)
+{
+    if (m_templates.remove(name) == 0) {
+        return true;
+    }
+    return save();
+}
+
+// 把全部模板写入文件，类型与完成状态相同的连续时段合并为一项
+bool DayTemplateStore::save() const
+{
+    QJsonArray templates;
+    for (auto it = m_templates.constBegin(); it != m_templates.constEnd(); ++it) {
+        const DayRecord& record = it.value();
+        QJsonArray items;
+        int slot = 0;
+        while (slot < DayRecord::kSlotCount) {
+            if (!record.hasSlot(slot)) {
+                ++slot;
+                continue;
+            }
+            const int first = slot;
+            while (slot < DayRecord::kSlotCount && record.categoryAt(slot) == record.categoryAt(first)
+                   && record.isCompleted(slot) == record.isCompleted(first)) {
+                ++slot;
+            }
+            QJsonObject item;
+            item.insert("slot", first);
+            item.insert("count", slot - first);
+            item.insert("type", CategoryTable::nameOf(record.categoryAt(first)));
+            item.insert("isCompleted", record.isCompleted(first));
+            items.append(item);
+        }
+
+        QJsonObject obj;
+        obj.insert("name", it.key());
+        obj.insert("items", items);
+        templates.append(obj);
+    }
+
+    QJsonObject rootObj;
+    rootObj.insert("templates", templates);
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "无法打开模板文件进行写入：" << m_path << "，错误：" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(rootObj).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        qCritical() << "模板文件写入失败：" << m_path << "，错误：" << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef DAYTEMPLATESTORE_H
+#define DAYTEMPLATESTORE_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The DayTemplateStore class
+ * 按名称保存的日程模板，每个模板是一份完整的单日记录。
+ * 模板只保存时段安排，完成状态一律清除，套用到以后的日期时均为未完成。
+ * 模板以JSON文件保存，时段按类型与完成状态相同的连续区间存放，类型以名称存放，与类型编号无关。
+ * 文件很小，每次修改后整体重写。
+ */
+class DayTemplateStore
+{
+public:
+    // 从文件加载模板，文件不存在时为空
+    // 参数1：模板文件路径
+    // 返回：是否成功，文件不存在也视为成功
+    bool load(const QString& path);
+
+    // 获取模板名称，按名称排序
+    QStringList names() const {return m_templates.keys();}
+
+    // 是否包含指定名称的模板
+    bool contains(const QString& name) const {return m_templates.contains(name);}
+
+    // 获取指定名称的模板，不存在时返回空记录
+    DayRecord value(const QString& name) const {return m_templates.value(name);}
+
+    // 保存模板，同名时覆盖，并写入文件
+    // 参数1：模板名称
+    // 参数2：单日记录，完成状态不会保存
+    // 返回：是否写入成功
+    bool insert(const QString& name, const DayRecord& record);
+
+    // 删除模板，并写入文件
+    // 参数1：模板名称
+    // 返回：是否写入成功
+    bool remove(const QString& name);
+
+private:
+    // 把全部模板写入文件
+    bool save() const;
+
+private:
+    QString m_path;
+    QMap<QString, DayRecord> m_templates;
+};
+
+#endif // DAYTEMPLATESTORE_H
@@ -0,0 +1,386 @@
+#include "saveworker.h"
+#include "utils/studylogstore.h"
+#include "utils/tracer.h"
+#include <QFile>
+#include <QDebug>
+#include <climits>
+
+namespace {
+// 快照写入失败后的重试间隔（毫秒）
+const int kSnapshotRetryMs = 5000;
+// 从第一条待写数据算起的最长等待时间（毫秒），持续编辑时合并窗口不会无限推迟
+const int kMaxPendingMs = 2000;
+}
+
+SaveWorker::SaveWorker(const QString& saveFilePath, const QString& journalFilePath, const QString& logDirectory)
+    : m_saveFilePath(saveFilePath)
+    , m_journalFilePath(journalFilePath)
+    , m_logDirectory(logDirectory)
+{
+    m_thread.setObjectName("SaveWorker");
+
+    // 作为子对象随工作者一起移动到后台线程
+    m_debounceTimer = new QTimer(this);
+    m_debounceTimer->setSingleShot(true);
+    connect(m_debounceTimer, &QTimer::timeout, this, &SaveWorker::writePending);
+
+    m_retryTimer = new QTimer(this);
+    m_retryTimer->setSingleShot(true);
+    m_retryTimer->setInterval(kSnapshotRetryMs);
+    connect(m_retryTimer, &QTimer::timeout, this, &SaveWorker::writePending);
+}
+
+SaveWorker::~SaveWorker()
+{
+    stop();
+}
+
+// 启动后台线程并打开预写日志
+bool SaveWorker::start()
+{
+    if (m_thread.isRunning()) {
+        return true;
+    }
+    if (!m_journal.open(m_journalFilePath)) {
+        qCritical() << "后台保存线程无法打开预写日志：" << m_journalFilePath;
+        return false;
+    }
+    // 合并窗口结束时统一刷盘，不再按条数或时间触发
+    m_journal.setSyncBatchSize(INT_MAX);
+    m_journal.setSyncInterval(INT_MAX);
+
+    moveToThread(&m_thread);
+    m_thread.start();
+    qDebug() << "后台保存线程已启动";
+    return true;
+}
+
+// 写出全部待写数据并停止后台线程
+void SaveWorker::stop()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+    // 写出剩余数据后把对象移回调用线程，线程结束后仍可安全使用与析构
+    QThread* callerThread = QThread::currentThread();
+    QMetaObject::invokeMethod(this, [this, callerThread]() {
+        writePending();
+        moveToThread(callerThread);
+    }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+    // 预写日志留到析构时关闭，停止后送达的替换确认仍需清空日志
+    qDebug() << "后台保存线程已停止";
+}
+
+// 设置合并写入的时间窗口
+void SaveWorker::setDebounceInterval(int ms)
+{
+    const int interval = qMax(0, ms);
+    if (!m_thread.isRunning()) {
+        m_debounceInterval = interval;
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, interval]() {
+        m_debounceInterval = interval;
+    }, Qt::QueuedConnection);
+}
+
+// 提交一条预写日志记录
+void SaveWorker::postJournalEntry(const StudyJournal::Entry& entry)
+{
+    QMetaObject::invokeMethod(this, [this, entry]() {
+        enqueueJournalEntry(entry);
+    }, Qt::QueuedConnection);
+}
+
+// 提交一份整体快照
+void SaveWorker::postSnapshot(const SaveSnapshot& snapshot)
+{
+    QMetaObject::invokeMethod(this, [this, snapshot]() {
+        enqueueSnapshot(snapshot);
+    }, Qt::QueuedConnection);
+}
+
+// 告知快照的临时文件已被替换为存档
+// 后台线程已停止时直接处理，停止保存线程时送达的确认不会丢失
+void SaveWorker::postSnapshotInstalled(quint64 sequence, bool installed)
+{
+    if (!m_thread.isRunning()) {
+        finishSnapshot(sequence, installed);
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, sequence, installed]() {
+        finishSnapshot(sequence, installed);
+    }, Qt::QueuedConnection);
+}
+
+// 阻塞直到已提交的数据全部写入磁盘
+// 队列中在此之前提交的任务会先被处理，因此返回时所有提交都已落盘
+void SaveWorker::flush()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+    if (QThread::currentThread() == &m_thread) {
+        writePending();
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this]() {
+        writePending();
+    }, Qt::BlockingQueuedConnection);
+}
+
+// 缓冲一条预写日志记录，并重新开始合并窗口
+void SaveWorker::enqueueJournalEntry(const StudyJournal::Entry& entry)
+{
+    m_pendingEntries.append(entry);
+    if (m_hasPendingSnapshot) {
+        m_postSnapshotEntries.append(entry);
+    }
+    restartDebounce();
+}
+
+// 缓冲一份整体快照，之前缓冲的日志记录已包含在快照中，但要保留到快照写入成功为止
+void SaveWorker::enqueueSnapshot(const SaveSnapshot& snapshot)
+{
+    m_pendingSnapshot = snapshot;
+    m_hasPendingSnapshot = true;
+    m_postSnapshotEntries.clear();
+    restartDebounce();
+}
+
+// 快照替换存档后的处理：成功时清空预写日志，否则稍后重新写入
+void SaveWorker::finishSnapshot(quint64 sequence, bool installed)
+{
+    m_awaitingInstall = false;
+    if (!m_hasPendingSnapshot) {
+        return;
+    }
+
+    // 等待期间又提交了新的快照，立即写入新快照，预写日志保留到新快照替换存档为止
+    if (sequence != m_pendingSnapshot.sequence) {
+        if (m_thread.isRunning()) {
+            restartDebounce();
+        } else {
+            writePending();
+        }
+        return;
+    }
+
+    if (!installed) {
+        qCritical() << "存档替换失败，" << kSnapshotRetryMs << "毫秒后重试";
+        if (m_thread.isRunning()) {
+            m_retryTimer->start();
+        }
+        return;
+    }
+
+    m_pendingSnapshot = SaveSnapshot();
+    m_hasPendingSnapshot = false;
+    // 存档已包含快照之前的全部变更，清空预写日志，只需重新写入快照之后提交的记录
+    if (m_journal.isOpen()) {
+        m_journal.reset();
+    }
+    m_pendingEntries = m_postSnapshotEntries;
+    m_postSnapshotEntries.clear();
+    writePending();
+}
+
+// 重新开始合并窗口，但从第一条待写数据算起不超过最长等待时间
+void SaveWorker::restartDebounce()
+{
+    if (!m_pendingSince.isValid()) {
+        m_pendingSince.start();
+    }
+    const qint64 maxWait = qMax(kMaxPendingMs, m_debounceInterval);
+    const qint64 remaining = maxWait - m_pendingSince.elapsed();
+    m_debounceTimer->start(int(qBound<qint64>(0, remaining, m_debounceInterval)));
+}
+
+// 写出缓冲的快照与日志记录
+// 快照写入失败时保留快照稍后重试，缓冲的记录照常追加到预写日志，重试之前的编辑不会丢失；
+// 等待替换存档期间不写新快照，记录同样先追加到预写日志
+void SaveWorker::writePending()
+{
+    m_debounceTimer->stop();
+    m_retryTimer->stop();
+    m_pendingSince.invalidate();
+
+    if (m_hasPendingSnapshot && !m_awaitingInstall) {
+        const SaveSnapshot snapshot = m_pendingSnapshot;
+        const bool ok = writeSnapshot(snapshot, m_saveFilePath, m_logDirectory);
+        if (ok) {
+            m_awaitingInstall = true;
+        } else {
+            qCritical() << "整体快照写入失败，" << kSnapshotRetryMs << "毫秒后重试，变更先写入预写日志";
+            m_retryTimer->start();
+        }
+        emit snapshotWritten(ok, snapshot.sequence, snapshot.editSerial);
+    }
+
+    if (m_pendingEntries.isEmpty()) {
+        return;
+    }
+
+    int written = 0;
+    for (const StudyJournal::Entry& entry : std::as_const(m_pendingEntries)) {
+        if (!m_journal.append(entry)) {
+            break;
+        }
+        ++written;
+    }
+    m_journal.sync();
+
+    // 写入失败的记录继续缓冲，下次写入或整体保存时再写
+    if (written != m_pendingEntries.size()) {
+        qCritical() << "预写日志写入失败，" << m_pendingEntries.size() - written << "条变更将在下次写入时重试";
+        m_retryTimer->start();
+    }
+    m_pendingEntries.remove(0, written);
+}
+
+// 同步写入整体快照的临时文件
+bool SaveWorker::writeSnapshot(const SaveSnapshot& snapshot, const QString& saveFilePath, const QString& logDirectory)
+{
+    qDebug() << "开始保存学习数据...";
+
+    // 需要合并时在本线程映射存档，未修改的日期直接从映射中读取，函数返回时随文件关闭释放映射
+    QFile archiveFile(saveFilePath);
+    StudyCodec::View base;
+    if (snapshot.mergeArchive) {
+        uchar* mapped = nullptr;
+        if (archiveFile.open(QIODevice::ReadOnly) && archiveFile.size() > 0) {
+            mapped = archiveFile.map(0, archiveFile.size());
+        }
+        QString baseError;
+        if (!mapped || !base.attach(mapped, archiveFile.size(), &baseError)) {
+            qCritical() << "存档无法映射，跳过保存：" << (mapped ? baseError : archiveFile.errorString());
+            return false;
+        }
+        if (!base.verifyChecksum()) {
+            qCritical() << "存档校验失败，跳过保存：" << saveFilePath;
+            return false;
+        }
+    }
+
+    QByteArray saveData = StudyCodec::encodeMerged(base, snapshot.days, snapshot.maxContinuousDays);
+    if (saveData.isEmpty()) {
+        qCritical() << "数据序列化失败，跳过保存";
+        return false;
+    }
+
+    qDebug() << "数据序列化成功，数据大小：" << saveData.size() << "字节，合并了" << snapshot.days.size() << "天的学习数据";
+
+    QString tempFilePath = saveFilePath + ".tmp";
+    QFile tempFile(tempFilePath);
+    if(!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "临时文件打开失败：" << tempFilePath << "，错误：" << tempFile.errorString();
+        return false;
+    }
+
+    qint64 written = tempFile.write(saveData);
+    tempFile.close();
+
+    if (tempFile.error() != QFile::NoError) {
+        qCritical() << "临时文件写入过程中发生错误：" << tempFile.errorString();
+        QFile::remove(tempFilePath);
+        return false;
+    }
+
+    if (written != saveData.size()) {
+        qCritical() << "临时文件写入不完整，预期写入" << saveData.size() << "字节，实际写入" << written << "字节";
+        QFile::remove(tempFilePath);
+        return false;
+    }
+
+    qDebug() << "临时文件写入成功：" << tempFilePath;
+
+    // 保存数据后写入日志
+    writeDayLog(snapshot, base, logDirectory);
+    return true;
+}
+
+// 用写好的临时文件替换存档
+bool SaveWorker::installSnapshot(const QString& saveFilePath)
+{
+    QString tempFilePath = saveFilePath + ".tmp";
+
+    // 备份原有文件
+    QString backupFilePath = saveFilePath + ".bak";
+    bool backupSuccess = true;
+
+    if (QFile::exists(saveFilePath)) {
+        // 删除旧备份
+        QFile::remove(backupFilePath);
+
+        if (!QFile::rename(saveFilePath, backupFilePath)) {
+            qWarning() << "创建备份文件失败：" << backupFilePath;
+            backupSuccess = false;
+        } else {
+            qDebug() << "原有文件备份成功：" << backupFilePath;
+        }
+    }
+
+    // 替换原有文件
+    if (!QFile::rename(tempFilePath, saveFilePath)) {
+        qCritical() << "覆盖存档文件失败：" << saveFilePath;
+        QFile::remove(tempFilePath);
+
+        // 尝试恢复备份
+        if (backupSuccess && QFile::exists(backupFilePath)) {
+            if (QFile::rename(backupFilePath, saveFilePath)) {
+                qDebug() << "从备份恢复存档文件成功";
+            } else {
+                qCritical() << "从备份恢复存档文件失败";
+            }
+        }
+
+        return false;
+    }
+
+    qDebug() << "学习数据保存成功：" << saveFilePath;
+
+    // 删除备份文件
+    QFile::remove(backupFilePath);
+    return true;
+}
+
+// 写入当天的日志
+void SaveWorker::writeDayLog(const SaveSnapshot& snapshot, const StudyCodec::View& base, const QString& logDirectory)
+{
+    QDate currentDate = QDate::currentDate();
+    DayRecord record;
+    auto it = snapshot.days.constFind(currentDate);
+    if (it != snapshot.days.constEnd()) {
+        record = it.value();
+    } else {
+        const int index = base.indexOf(currentDate);
+        if (index < 0 || !base.recordAt(index, record)) {
+            return;
+        }
+    }
+
+    StudyLogStore logs;
+    if (!logs.open(logDirectory)) {
+        return;
+    }
+    if (!logs.write(currentDate, record, snapshot.maxContinuousDays)) {
+        return;
+    }
+
+    qDebug() << "日志保存成功：" << currentDate.toString("yyyy-MM-dd");
+
+    // 清理旧日志
+    logs.prune(currentDate, StudyLogStore::kDaysToKeep);
+}
+
+// 清理超过保留天数的每日日志
+void SaveWorker::cleanupOldLogs(const QString& logDirectory)
+{
+    TraceScope trace("SaveWorker::cleanupOldLogs");
+    StudyLogStore logs;
+    if (logs.open(logDirectory)) {
+        logs.prune(QDate::currentDate(), StudyLogStore::kDaysToKeep);
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef SAVEWORKER_H
+#define SAVEWORKER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QDate>
+#include <QList>
+#include "utils/dayrecord.h"
+#include "utils/studycodec.h"
+#include "utils/studyjournal.h"
+
+// 一次整体保存所需的数据快照，QMap隐式共享，拷贝只增加引用计数
+// mergeArchive为true时，days只包含修改过的日期，由写入方映射磁盘上的存档合并编码
+struct SaveSnapshot
+{
+    QMap<QDate, DayRecord> days;
+    bool mergeArchive = false;
+    int maxContinuousDays = 0;
+    quint64 sequence = 0;
+    quint64 editSerial = 0; // 快照包含的修改序号，替换存档后据此保留之后的编辑
+};
+
+/**
+ * @brief The SaveWorker class
+ * 后台持久化线程，编辑过程中的所有磁盘读写都在这里完成。
+ * 预写日志记录先在内存中缓冲，在可配置的时间窗口内合并后一次写入并刷盘，
+ * 持续编辑时从第一条待写数据算起最多等待固定的时长；
+ * 整体快照同样在窗口结束时写入，窗口内多次请求只写最新的一份；
+ * 快照只写成临时文件，存档被界面线程映射着，由界面线程替换后通过postSnapshotInstalled()告知，
+ * 确认之前不写新的快照，确认替换成功后才清空预写日志；
+ * 快照写入失败时，缓冲的记录改为追加到预写日志，并在一段时间后重试写入快照。
+ * flush()会阻塞到所有已提交的数据落盘，供退出与备份前等待。
+ */
+class SaveWorker : public QObject
+{
+    Q_OBJECT
+public:
+    // 参数1：存档路径
+    // 参数2：预写日志路径
+    // 参数3：每日日志目录
+    SaveWorker(const QString& saveFilePath, const QString& journalFilePath, const QString& logDirectory);
+    ~SaveWorker();
+
+    // 启动后台线程并打开预写日志
+    // 返回：是否成功
+    bool start();
+
+    // 写出全部待写数据并停止后台线程
+    void stop();
+
+    // 后台线程是否在运行
+    bool isRunning() const {return m_thread.isRunning();}
+
+    // 设置合并写入的时间窗口
+    // 参数1：毫秒数
+    void setDebounceInterval(int ms);
+
+    // 提交一条预写日志记录，可在任意线程调用
+    void postJournalEntry(const StudyJournal::Entry& entry);
+
+    // 提交一份整体快照，写入并替换存档后清空预写日志，可在任意线程调用
+    void postSnapshot(const SaveSnapshot& snapshot);
+
+    // 告知快照的临时文件已被替换为存档，可在任意线程调用
+    // 参数1：快照序号
+    // 参数2：是否替换成功，失败时稍后重新写入
+    void postSnapshotInstalled(quint64 sequence, bool installed);
+
+    // 阻塞直到已提交的数据全部写入磁盘
+    void flush();
+
+    // 同步写入整体快照的临时文件，需要合并时自行映射存档读取未修改的日期，并写入当天日志
+    // 参数1：数据快照
+    // 参数2：存档路径
+    // 参数3：每日日志目录
+    // 返回：是否成功
+    static bool writeSnapshot(const SaveSnapshot& snapshot, const QString& saveFilePath, const QString& logDirectory);
+
+    // 用写好的临时文件替换存档：备份原存档 -> 替换，失败时恢复备份
+    // 调用前需释放对存档的映射
+    // 参数1：存档路径
+    // 返回：是否成功
+    static bool installSnapshot(const QString& saveFilePath);
+
+    // 清理超过保留天数的每日日志
+    // 参数1：每日日志目录
+    static void cleanupOldLogs(const QString& logDirectory);
+
+signals:
+    // 整体快照的临时文件写入完成（在后台线程发出），成功时需替换存档并调用postSnapshotInstalled()
+    // 参数1：是否成功
+    // 参数2：快照序号
+    // 参数3：快照包含的修改序号
+    void snapshotWritten(bool ok, quint64 sequence, quint64 editSerial);
+
+private:
+    // 以下函数只在后台线程执行
+    void enqueueJournalEntry(const StudyJournal::Entry& entry);
+    void enqueueSnapshot(const SaveSnapshot& snapshot);
+    void finishSnapshot(quint64 sequence, bool installed);
+    void restartDebounce();
+    void writePending();
+
+    // 写入当天的日志
+    // 参数1：数据快照
+    // 参数2：快照对应的存档视图，当天未修改时从中读取
+    // 参数3：每日日志目录
+    static void writeDayLog(const SaveSnapshot& snapshot, const StudyCodec::View& base, const QString& logDirectory);
+
+private:
+    QString m_saveFilePath;
+    QString m_journalFilePath;
+    QString m_logDirectory;
+
+    QThread m_thread;
+    QTimer* m_debounceTimer = nullptr;
+    QTimer* m_retryTimer = nullptr;
+    int m_debounceInterval = 500;
+    QElapsedTimer m_pendingSince; // 第一条待写数据提交的时间
+    StudyJournal m_journal;
+
+    QList<StudyJournal::Entry> m_pendingEntries;      // 尚未写入预写日志的记录
+    QList<StudyJournal::Entry> m_postSnapshotEntries; // 待写快照之后提交的记录，快照写入清空日志后需要重新追加
+    SaveSnapshot m_pendingSnapshot;
+    bool m_hasPendingSnapshot = false;
+    bool m_awaitingInstall = false; // 已写好临时文件，等待界面线程替换存档
+};
+
+#endif // SAVEWORKER_H
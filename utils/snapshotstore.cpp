@@ -0,0 +1,350 @@
+#include "snapshotstore.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QDebug>
+
+namespace {
+const char* kManifestHeader = "PTSNAP 1";
+
+// 以临时文件替换的方式写出整个文件
+bool writeFileAtomically(const QString& path, const QByteArray& data)
+{
+    const QString tempPath = path + ".tmp";
+    QFile tempFile(tempPath);
+    if (!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "临时文件打开失败：" << tempPath << "，错误：" << tempFile.errorString();
+        return false;
+    }
+    const qint64 written = tempFile.write(data);
+    tempFile.close();
+    if (written != data.size() || tempFile.error() != QFile::NoError) {
+        qCritical() << "临时文件写入失败：" << tempPath << "，错误：" << tempFile.errorString();
+        QFile::remove(tempPath);
+        return false;
+    }
+    QFile::remove(path);
+    if (!QFile::rename(tempPath, path)) {
+        qCritical() << "替换文件失败：" << path;
+        QFile::remove(tempPath);
+        return false;
+    }
+    return true;
+}
+}
+
+SnapshotStore::SnapshotStore(const QString& directory)
+    : m_directory(directory)
+    , m_chunkDirectory(directory + "/chunks")
+{
+}
+
+// 创建一次快照
+bool SnapshotStore::create(const QMap<QDate, DayRecord>& days, int maxContinuousDays, QString* manifestPath, int* writtenChunks, Manifest* created)
+{
+    if (!QDir().mkpath(m_chunkDirectory)) {
+        qCritical() << "无法创建快照目录：" << m_chunkDirectory;
+        return false;
+    }
+
+    Manifest manifest;
+    manifest.createdAt = QDateTime::currentDateTime();
+    manifest.maxContinuousDays = maxContinuousDays;
+
+    // QMap按日期有序，逐月切块
+    int written = 0;
+    QMap<QDate, DayRecord> monthDays;
+    QDate month;
+    auto flushMonth = [&]() -> bool {
+        if (monthDays.isEmpty()) {
+            return true;
+        }
+        ChunkRef ref;
+        ref.month = month;
+        const int result = writeChunk(monthDays, ref);
+        if (result < 0) {
+            return false;
+        }
+        written += result;
+        manifest.chunks.append(ref);
+        monthDays.clear();
+        return true;
+    };
+
+    for (auto it = days.constBegin(); it != days.constEnd(); ++it) {
+        const QDate dayMonth(it.key().year(), it.key().month(), 1);
+        if (dayMonth != month) {
+            if (!flushMonth()) {
+                return false;
+            }
+            month = dayMonth;
+        }
+        monthDays.insert(it.key(), it.value());
+    }
+    if (!flushMonth()) {
+        return false;
+    }
+    return finish(manifest, written, manifestPath, writtenChunks, created);
+}
+
+// 以上一份清单为基础创建快照
+bool SnapshotStore::createFrom(const Manifest& base, const QMap<QDate, QMap<QDate, DayRecord>>& changedMonths, int maxContinuousDays,
+                               QString* manifestPath, int* writtenChunks, Manifest* created)
+{
+    if (!QDir().mkpath(m_chunkDirectory)) {
+        qCritical() << "无法创建快照目录：" << m_chunkDirectory;
+        return false;
+    }
+
+    Manifest manifest;
+    manifest.createdAt = QDateTime::currentDateTime();
+    manifest.maxContinuousDays = maxContinuousDays;
+
+    // 两边都按月份有序，逐月合并：修改过的月份重新编码，其余直接沿用分块引用
+    int written = 0;
+    auto baseIt = base.chunks.constBegin();
+    auto changeIt = changedMonths.constBegin();
+    while (baseIt != base.chunks.constEnd() || changeIt != changedMonths.constEnd()) {
+        if (changeIt == changedMonths.constEnd() || (baseIt != base.chunks.constEnd() && baseIt->month < changeIt.key())) {
+            if (!QFile::exists(chunkPath(baseIt->hash))) {
+                qWarning() << "上一份快照的分块缺失：" << baseIt->month.toString("yyyy-MM");
+                return false;
+            }
+            manifest.chunks.append(*baseIt);
+            ++baseIt;
+            continue;
+        }
+        if (baseIt != base.chunks.constEnd() && baseIt->month == changeIt.key()) {
+            ++baseIt;
+        }
+        if (!changeIt.value().isEmpty()) {
+            ChunkRef ref;
+            ref.month = changeIt.key();
+            const int result = writeChunk(changeIt.value(), ref);
+            if (result < 0) {
+                return false;
+            }
+            written += result;
+            manifest.chunks.append(ref);
+        }
+        ++changeIt;
+    }
+    return finish(manifest, written, manifestPath, writtenChunks, created);
+}
+
+// 写出新的清单文件并输出结果
+bool SnapshotStore::finish(const Manifest& manifest, int written, QString* manifestPath, int* writtenChunks, Manifest* created)
+{
+    // 同一秒内多次快照时追加序号，避免覆盖
+    const QString baseName = m_directory + "/snapshot_" + manifest.createdAt.toString("yyyyMMdd_HHmmss");
+    QString path = baseName + "." + kManifestSuffix;
+    for (int i = 1; QFile::exists(path); ++i) {
+        path = QString("%1_%2.%3").arg(baseName).arg(i).arg(kManifestSuffix);
+    }
+    if (!writeManifest(path, manifest)) {
+        return false;
+    }
+
+    qDebug() << "快照创建成功：" << path << "，共" << manifest.chunks.size() << "个月份分块，新写入" << written << "个";
+    if (manifestPath) {
+        *manifestPath = path;
+    }
+    if (writtenChunks) {
+        *writtenChunks = written;
+    }
+    if (created) {
+        *created = manifest;
+    }
+    return true;
+}
+
+// 按清单恢复数据
+bool SnapshotStore::restore(const QString& manifestPath, const StudyCodec::DayVisitor& visitor, int& maxContinuousDays, QString* errorString)
+{
+    Manifest manifest;
+    if (!readManifest(manifestPath, manifest)) {
+        if (errorString) {
+            *errorString = "快照清单无法识别";
+        }
+        return false;
+    }
+
+    // 先完整解码全部分块，确认无误后再交给访问者
+    QMap<QDate, DayRecord> days;
+    for (const ChunkRef& ref : std::as_const(manifest.chunks)) {
+        const QString path = chunkPath(ref.hash);
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            if (errorString) {
+                *errorString = QString("%1的分块缺失：%2").arg(ref.month.toString("yyyy-MM"), path);
+            }
+            return false;
+        }
+        const QByteArray data = file.readAll();
+        file.close();
+
+        if (QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex() != ref.hash) {
+            if (errorString) {
+                *errorString = QString("%1的分块内容与哈希不符").arg(ref.month.toString("yyyy-MM"));
+            }
+            return false;
+        }
+
+        int chunkMaxContinuous = 0;
+        QString chunkError;
+        const bool ok = StudyCodec::decode(data, [&days](const QDate& date, const DayRecord& record) {
+            days.insert(date, record);
+        }, chunkMaxContinuous, &chunkError);
+        if (!ok) {
+            if (errorString) {
+                *errorString = QString("%1的分块解析失败：%2").arg(ref.month.toString("yyyy-MM"), chunkError);
+            }
+            return false;
+        }
+    }
+
+    for (auto it = days.constBegin(); it != days.constEnd(); ++it) {
+        visitor(it.key(), it.value());
+    }
+    maxContinuousDays = manifest.maxContinuousDays;
+    return true;
+}
+
+// 获取全部清单文件路径，最新的在前
+QStringList SnapshotStore::manifests() const
+{
+    QDir dir(m_directory);
+    const QFileInfoList files = dir.entryInfoList(QStringList() << QString("*.") + kManifestSuffix, QDir::Files, QDir::Name | QDir::Reversed);
+    QStringList paths;
+    for (const QFileInfo& fileInfo : files) {
+        paths.append(fileInfo.absoluteFilePath());
+    }
+    return paths;
+}
+
+// 只保留最新的若干个快照，并删除不再被引用的分块
+int SnapshotStore::prune(int manifestsToKeep)
+{
+    const QStringList paths = manifests();
+    QSet<QByteArray> referenced;
+    for (int i = 0; i < paths.size(); ++i) {
+        if (i >= manifestsToKeep) {
+            if (QFile::remove(paths[i])) {
+                qDebug() << "删除旧快照：" << paths[i];
+            }
+            continue;
+        }
+        Manifest manifest;
+        if (!readManifest(paths[i], manifest)) {
+            // 无法识别的清单可能引用任意分块，放弃本次清理
+            qWarning() << "快照清单无法识别，跳过分块清理：" << paths[i];
+            return 0;
+        }
+        for (const ChunkRef& ref : std::as_const(manifest.chunks)) {
+            referenced.insert(ref.hash);
+        }
+    }
+
+    int removed = 0;
+    QDir chunkDir(m_chunkDirectory);
+    const QFileInfoList chunks = chunkDir.entryInfoList(QStringList() << "*.chunk", QDir::Files);
+    for (const QFileInfo& fileInfo : chunks) {
+        if (!referenced.contains(fileInfo.completeBaseName().toLatin1())) {
+            if (QFile::remove(fileInfo.absoluteFilePath())) {
+                ++removed;
+            }
+        }
+    }
+    if (removed > 0) {
+        qDebug() << "删除" << removed << "个不再被引用的快照分块";
+    }
+    return removed;
+}
+
+// 判断路径是否为快照清单
+bool SnapshotStore::isManifest(const QString& path)
+{
+    return QFileInfo(path).suffix().compare(kManifestSuffix, Qt::CaseInsensitive) == 0;
+}
+
+// 读取清单文件
+// 格式为逐行文本：首行为文件头，随后是创建时间、最大连续天数与各月分块
+bool SnapshotStore::readManifest(const QString& path, Manifest& manifest)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    file.close();
+
+    if (lines.isEmpty() || lines.first().trimmed() != kManifestHeader) {
+        return false;
+    }
+
+    manifest = Manifest();
+    for (int i = 1; i < lines.size(); ++i) {
+        const QList<QByteArray> fields = lines[i].trimmed().split(' ');
+        if (fields.first().isEmpty()) {
+            continue;
+        }
+        if (fields.first() == "created" && fields.size() == 2) {
+            manifest.createdAt = QDateTime::fromString(QString::fromLatin1(fields[1]), Qt::ISODate);
+        } else if (fields.first() == "maxContinuousDays" && fields.size() == 2) {
+            manifest.maxContinuousDays = fields[1].toInt();
+        } else if (fields.first() == "chunk" && fields.size() == 4) {
+            ChunkRef ref;
+            ref.month = QDate::fromString(QString::fromLatin1(fields[1]) + "-01", "yyyy-MM-dd");
+            ref.hash = fields[2];
+            ref.days = fields[3].toInt();
+            if (!ref.month.isValid() || ref.hash.isEmpty()) {
+                return false;
+            }
+            manifest.chunks.append(ref);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 写入单月分块，内容已存在时跳过
+int SnapshotStore::writeChunk(const QMap<QDate, DayRecord>& monthDays, ChunkRef& ref)
+{
+    // 分块内不保存最大连续天数，使未变化月份的内容保持不变
+    const QByteArray data = StudyCodec::encode(monthDays, 0);
+    if (data.isEmpty()) {
+        qCritical() << "快照分块序列化失败：" << ref.month.toString("yyyy-MM");
+        return -1;
+    }
+    ref.hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+    ref.days = monthDays.size();
+
+    const QString path = chunkPath(ref.hash);
+    if (QFile::exists(path)) {
+        return 0;
+    }
+    return writeFileAtomically(path, data) ? 1 : -1;
+}
+
+QString SnapshotStore::chunkPath(const QByteArray& hash) const
+{
+    return m_chunkDirectory + "/" + QString::fromLatin1(hash) + ".chunk";
+}
+
+// 写出清单文件
+bool SnapshotStore::writeManifest(const QString& path, const Manifest& manifest)
+{
+    QByteArray data;
+    data.append(kManifestHeader).append('\n');
+    data.append("created ").append(manifest.createdAt.toString(Qt::ISODate).toLatin1()).append('\n');
+    data.append("maxContinuousDays ").append(QByteArray::number(manifest.maxContinuousDays)).append('\n');
+    for (const ChunkRef& ref : manifest.chunks) {
+        data.append("chunk ").append(ref.month.toString("yyyy-MM").toLatin1())
+            .append(' ').append(ref.hash)
+            .append(' ').append(QByteArray::number(ref.days)).append('\n');
+    }
+    return writeFileAtomically(path, data);
+}
@@ -0,0 +1,112 @@
+#ifndef SNAPSHOTSTORE_H
+#define SNAPSHOTSTORE_H
+
+#include <QDate>
+#include <QDateTime>
+#include <QMap>
+#include <QList>
+#include <QStringList>
+#include "utils/dayrecord.h"
+#include "utils/studycodec.h"
+
+/**
+ * @brief The SnapshotStore class
+ * 增量去重的备份快照目录。
+ * 历史数据按月切成分块，每块以二进制存档编码后按内容哈希命名存入chunks子目录，
+ * 已存在的分块不再重复写入；每次快照只写一个列出各月分块哈希的清单文件（.ptm）。
+ * 已知上一份清单与之后修改过的月份时，可只编码这些月份，其余沿用上一份清单的分块。
+ * 恢复时按清单读取分块重建全部数据。
+ */
+class SnapshotStore
+{
+public:
+    // 清单中的单月分块
+    struct ChunkRef
+    {
+        QDate month;     // 月份（取每月1日）
+        QByteArray hash; // 分块内容哈希（十六进制）
+        int days = 0;    // 分块包含的天数
+    };
+
+    // 快照清单
+    struct Manifest
+    {
+        QDateTime createdAt;
+        int maxContinuousDays = 0;
+        QList<ChunkRef> chunks;
+    };
+
+    // 清单文件后缀
+    static constexpr const char* kManifestSuffix = "ptm";
+    // 默认保留的快照数量
+    static const int kManifestsToKeep = 30;
+
+public:
+    // 参数1：快照目录
+    explicit SnapshotStore(const QString& directory);
+
+    // 创建一次快照，只写入内容有变化的月份分块
+    // 参数1：全部学习数据
+    // 参数2：最大连续天数
+    // 参数3：输出，清单文件路径，可为nullptr
+    // 参数4：输出，本次新写入的分块数，可为nullptr
+    // 参数5：输出，本次快照的清单，可为nullptr
+    // 返回：是否成功
+    bool create(const QMap<QDate, DayRecord>& days, int maxContinuousDays, QString* manifestPath = nullptr, int* writtenChunks = nullptr, Manifest* created = nullptr);
+
+    // 以上一份清单为基础创建快照，只编码修改过的月份，其余月份沿用上一份清单的分块
+    // 参数1：上一份清单，引用的分块须仍然存在
+    // 参数2：修改过的月份（取每月1日）及其全部数据，数据为空表示该月已没有记录
+    // 参数3：最大连续天数
+    // 参数4：输出，清单文件路径，可为nullptr
+    // 参数5：输出，本次新写入的分块数，可为nullptr
+    // 参数6：输出，本次快照的清单，可为nullptr
+    // 返回：是否成功，沿用的分块缺失时失败，需改为完整创建
+    bool createFrom(const Manifest& base, const QMap<QDate, QMap<QDate, DayRecord>>& changedMonths, int maxContinuousDays,
+                    QString* manifestPath = nullptr, int* writtenChunks = nullptr, Manifest* created = nullptr);
+
+    // 按清单恢复数据，任一分块缺失或损坏时整体失败
+    // 参数1：清单文件路径
+    // 参数2：访问者，逐天调用
+    // 参数3：输出，最大连续天数
+    // 参数4：输出，错误信息，可为nullptr
+    // 返回：是否成功
+    bool restore(const QString& manifestPath, const StudyCodec::DayVisitor& visitor, int& maxContinuousDays, QString* errorString = nullptr);
+
+    // 获取全部清单文件路径，最新的在前
+    QStringList manifests() const;
+
+    // 只保留最新的若干个快照，并删除不再被引用的分块
+    // 参数1：保留的快照数量
+    // 返回：删除的分块数
+    int prune(int manifestsToKeep = kManifestsToKeep);
+
+    // 判断路径是否为快照清单
+    static bool isManifest(const QString& path);
+
+    // 读取清单文件
+    // 参数1：清单文件路径
+    // 参数2：输出，清单
+    // 返回：是否成功
+    static bool readManifest(const QString& path, Manifest& manifest);
+
+private:
+    // 写入单月分块，内容已存在时跳过
+    // 参数1：单月数据
+    // 参数2：输出，分块引用
+    // 返回：-1失败，0已存在，1新写入
+    int writeChunk(const QMap<QDate, DayRecord>& monthDays, ChunkRef& ref);
+
+    QString chunkPath(const QByteArray& hash) const;
+
+    // 写出新的清单文件并输出结果
+    bool finish(const Manifest& manifest, int written, QString* manifestPath, int* writtenChunks, Manifest* created);
+
+    static bool writeManifest(const QString& path, const Manifest& manifest);
+
+private:
+    QString m_directory;
+    QString m_chunkDirectory;
+};
+
+#endif // SNAPSHOTSTORE_H
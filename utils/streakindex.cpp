@@ -0,0 +1,115 @@
+#include "streakindex.h"
+
+// 清空索引
+void StreakIndex::clear()
+{
+    m_runs.clear();
+    m_lengths.clear();
+}
+
+// 设置某一天是否为学习日
+void StreakIndex::set(const QDate& date, bool qualifying)
+{
+    if (!date.isValid()) {
+        return;
+    }
+    const qint64 jd = date.toJulianDay();
+
+    // 起始日期不晚于该日的最后一个区间
+    auto it = m_runs.upperBound(jd);
+    const bool hasPrev = it != m_runs.begin();
+    if (hasPrev) {
+        --it;
+    }
+    const bool inside = hasPrev && it.value() >= jd;
+
+    if (!qualifying) {
+        // 从所在区间中拆出该日
+        if (!inside) {
+            return;
+        }
+        const qint64 first = it.key();
+        const qint64 last = it.value();
+        removeRun(it);
+        if (first < jd) {
+            addRun(first, jd - 1);
+        }
+        if (jd < last) {
+            addRun(jd + 1, last);
+        }
+        return;
+    }
+
+    if (inside) {
+        return;
+    }
+
+    // 与前后紧邻的区间合并
+    qint64 first = jd;
+    qint64 last = jd;
+    if (hasPrev && it.value() == jd - 1) {
+        first = it.key();
+        removeRun(it);
+    }
+    const auto next = m_runs.find(jd + 1);
+    if (next != m_runs.end()) {
+        last = next.value();
+        removeRun(next);
+    }
+    addRun(first, last);
+}
+
+// 获取包含指定日期的连续段
+StreakIndex::Streak StreakIndex::streakAt(const QDate& date) const
+{
+    if (!date.isValid()) {
+        return Streak();
+    }
+    const qint64 jd = date.toJulianDay();
+    auto it = m_runs.upperBound(jd);
+    if (it == m_runs.begin()) {
+        return Streak();
+    }
+    --it;
+    if (it.value() < jd) {
+        return Streak();
+    }
+    return Streak{QDate::fromJulianDay(it.key()), QDate::fromJulianDay(it.value())};
+}
+
+// 获取截至今天的连续天数，今天尚未学习时不中断昨天及之前的连续段
+int StreakIndex::currentStreak(const QDate& today) const
+{
+    const Streak streak = streakAt(today);
+    if (streak.isValid()) {
+        return int(streak.first.daysTo(today)) + 1;
+    }
+    return streakAt(today.addDays(-1)).length();
+}
+
+// 获取全部连续段
+QList<StreakIndex::Streak> StreakIndex::history() const
+{
+    QList<Streak> streaks;
+    streaks.reserve(m_runs.size());
+    for (auto it = m_runs.constBegin(); it != m_runs.constEnd(); ++it) {
+        streaks.append(Streak{QDate::fromJulianDay(it.key()), QDate::fromJulianDay(it.value())});
+    }
+    return streaks;
+}
+
+void StreakIndex::addRun(qint64 first, qint64 last)
+{
+    m_runs.insert(first, last);
+    ++m_lengths[int(last - first + 1)];
+}
+
+void StreakIndex::removeRun(QMap<qint64, qint64>::iterator it)
+{
+    const int length = int(it.value() - it.key() + 1);
+    auto lengthIt = m_lengths.find(length);
+    if (lengthIt != m_lengths.end() && --lengthIt.value() == 0) {
+        m_lengths.erase(lengthIt);
+    }
+    m_runs.erase(it);
+}
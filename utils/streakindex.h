@@ -0,0 +1,70 @@
+#ifndef STREAKINDEX_H
+#define STREAKINDEX_H
+
+#include <QDate>
+#include <QList>
+#include <QMap>
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The StreakIndex class
+ * 连续学习天数索引，以儒略日区间保存所有“学习日”的连续段。
+ * 学习日指学习时长大于零的日期（达到目标的日期必然满足），只打开过、没有学习记录的日期不计入。
+ * 区间按起始日期有序存放，另按长度计数，单日修改只合并或拆分相邻区间：
+ * 修改、查询当前连续天数与最长连续天数均为O(log n)，列出全部连续段为O(k)。
+ */
+class StreakIndex
+{
+public:
+    // 一段连续的学习日
+    struct Streak
+    {
+        QDate first; // 第一天，无效表示不存在
+        QDate last;  // 最后一天
+
+        bool isValid() const {return first.isValid();}
+        int length() const {return isValid() ? int(first.daysTo(last)) + 1 : 0;}
+    };
+
+    // 单日记录是否算作学习日
+    static bool qualifies(const DayRecord& record){return record.studyMinutes > 0;}
+
+public:
+    // 清空索引
+    void clear();
+
+    // 设置某一天是否为学习日，只合并或拆分相邻的区间
+    // 参数1：日期
+    // 参数2：是否为学习日
+    void set(const QDate& date, bool qualifying);
+
+    // 是否为学习日
+    bool contains(const QDate& date) const {return streakAt(date).isValid();}
+
+    // 获取包含指定日期的连续段，不是学习日时返回无效的连续段
+    Streak streakAt(const QDate& date) const;
+
+    // 获取截至今天的连续天数，今天尚未学习时计算到昨天为止
+    // 参数1：今天
+    int currentStreak(const QDate& today) const;
+
+    // 获取最长连续天数
+    int longestStreak() const {return m_lengths.isEmpty() ? 0 : m_lengths.lastKey();}
+
+    // 获取全部连续段，按日期顺序
+    QList<Streak> history() const;
+
+    // 获取连续段数
+    int count() const {return m_runs.size();}
+
+private:
+    // 增加或删除一个区间，同时维护长度计数
+    void addRun(qint64 first, qint64 last);
+    void removeRun(QMap<qint64, qint64>::iterator it);
+
+private:
+    QMap<qint64, qint64> m_runs; // 起始儒略日 -> 结束儒略日（含），区间互不相邻
+    QMap<int, int> m_lengths;    // 区间长度 -> 个数
+};
+
+#endif // STREAKINDEX_H
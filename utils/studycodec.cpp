@@ -0,0 +1,512 @@
+#include "studycodec.h"
+#include "utils/studyjsonreader.h"
+#include <QFile>
+#include <cstring>
+#include <QtEndian>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+namespace {
+const char kMagic[4] = {'P', 'T', 'S', 'D'};
+const int kHeaderSize = 8; // 魔数4字节 + 版本2字节 + 标志2字节
+
+// 追加小端整数
+template <typename T>
+void put(QByteArray& out, T value)
+{
+    char buf[sizeof(T)];
+    qToLittleEndian<T>(value, buf);
+    out.append(buf, sizeof(T));
+}
+
+// 带边界检查的顺序读取器
+struct Reader
+{
+    const uchar* data;
+    qint64 size;
+    qint64 pos = 0;
+    bool ok = true;
+
+    template <typename T>
+    T get()
+    {
+        if (!ok || pos + qint64(sizeof(T)) > size) {
+            ok = false;
+            return T();
+        }
+        T value = qFromLittleEndian<T>(data + pos);
+        pos += sizeof(T);
+        return value;
+    }
+
+    QString getString(int len)
+    {
+        if (!ok || pos + len > size) {
+            ok = false;
+            return QString();
+        }
+        QString value = QString::fromUtf8(reinterpret_cast<const char*>(data + pos), len);
+        pos += len;
+        return value;
+    }
+};
+
+void setError(QString* errorString, const QString& message)
+{
+    if (errorString) {
+        *errorString = message;
+    }
+}
+}
+
+// 编码学习数据
+QByteArray StudyCodec::encode(const QMap<QDate, DayRecord>& days, int maxContinuousDays, Format format)
+{
+    if (format == Json) {
+        return encodeJson(days, maxContinuousDays);
+    }
+    return encodeBinary([&days](const DayVisitor& visitor) {
+        for (auto it = days.constBegin(); it != days.constEnd(); ++it) {
+            visitor(it.key(), it.value());
+        }
+    }, days.size(), maxContinuousDays);
+}
+
+// 把修改过的日期合并进已有的二进制存档
+// 按日期顺序同时走存档索引与修改集合，存档中未修改的日期解码一天、编码一天
+QByteArray StudyCodec::encodeMerged(const View& base, const QMap<QDate, DayRecord>& changes, int maxContinuousDays)
+{
+    return encodeBinary([&base, &changes](const DayVisitor& visitor) {
+        auto changeIt = changes.constBegin();
+        DayRecord record;
+        for (int i = 0; i < base.dayCount(); ++i) {
+            const QDate date = base.dateAt(i);
+            for (; changeIt != changes.constEnd() && changeIt.key() < date; ++changeIt) {
+                visitor(changeIt.key(), changeIt.value());
+            }
+            if (changeIt != changes.constEnd() && changeIt.key() == date) {
+                visitor(changeIt.key(), changeIt.value());
+                ++changeIt;
+                continue;
+            }
+            if (!base.recordAt(i, record)) {
+                qWarning() << "存档中" << date << "的数据已损坏，已跳过";
+                continue;
+            }
+            visitor(date, record);
+        }
+        for (; changeIt != changes.constEnd(); ++changeIt) {
+            visitor(changeIt.key(), changeIt.value());
+        }
+    }, base.dayCount() + changes.size(), maxContinuousDays);
+}
+
+// 解码学习数据，自动识别格式，完整成功后才写入输出
+bool StudyCodec::decode(const QByteArray& data, QMap<QDate, DayRecord>& days, int& maxContinuousDays, QString* errorString)
+{
+    QMap<QDate, DayRecord> decoded;
+    int decodedMaxContinuous = maxContinuousDays;
+    const bool ok = decode(data, [&decoded](const QDate& date, const DayRecord& record) {
+        decoded.insert(date, record);
+    }, decodedMaxContinuous, errorString);
+    if (!ok) {
+        return false;
+    }
+    days = decoded;
+    maxContinuousDays = decodedMaxContinuous;
+    return true;
+}
+
+// 解码学习数据，逐天交给访问者
+bool StudyCodec::decode(const QByteArray& data, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString)
+{
+    if (data.isEmpty()) {
+        setError(errorString, "数据为空");
+        return false;
+    }
+    return isBinary(data) ? decodeBinary(data, visitor, maxContinuousDays, errorString)
+                          : decodeJson(data, visitor, maxContinuousDays, errorString);
+}
+
+// 以内存映射方式读取文件并解码，映射失败时退回到完整读取
+bool StudyCodec::decodeFile(const QString& path, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(errorString, file.errorString());
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size <= 0) {
+        setError(errorString, "文件为空");
+        return false;
+    }
+
+    uchar* mapped = file.map(0, size);
+    if (!mapped) {
+        return decode(file.readAll(), visitor, maxContinuousDays, errorString);
+    }
+    const bool ok = decode(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), size), visitor, maxContinuousDays, errorString);
+    file.unmap(mapped);
+    return ok;
+}
+
+// 判断字节是否为二进制格式
+bool StudyCodec::isBinary(const QByteArray& data)
+{
+    return data.size() >= kHeaderSize && memcmp(data.constData(), kMagic, 4) == 0;
+}
+
+// 根据文件后缀推断编码格式，.json为JSON，其余为二进制
+StudyCodec::Format StudyCodec::formatForPath(const QString& path)
+{
+    return QFileInfo(path).suffix().compare("json", Qt::CaseInsensitive) == 0 ? Json : Binary;
+}
+
+// 二进制布局（版本3，小端）：
+// [0]  魔数"PTSD" [4]版本u16 [6]标志u16
+// [8]  最大连续天数i32 [12]类型数u16 [14]保留u16
+// [16] 天数u32 [20]索引偏移u32 [24]时段数据偏移u32 [28]时段数据长度u32
+// [32] 类型表{[长度u8][UTF-8]}...，只包含数据中用到的类型，按首次出现的顺序编号
+// 索引：按儒略日升序，每项14字节{[儒略日i32][游程偏移u32][学习分钟数u16][完成数u8][总数u8][游程数u8][保留u8]}
+// 时段数据：连续且类型与完成状态相同的15分钟时段合并为一个游程，每个4字节{[首时段u8][时段数u8][类型编号u8][完成u8]}
+// [末尾] 校验u16，覆盖第8字节至末尾前的全部内容
+namespace {
+const int kFixedHeaderSize = 32;
+const int kIndexEntrySize = 14;
+const int kRunSize = 4;
+}
+
+QByteArray StudyCodec::encodeBinary(const DaySource& source, int dayCountHint, int maxContinuousDays)
+{
+    // 类型表只收录数据中出现的类型，编号由内容决定，与类型字典中的其他类型无关，
+    // 快照分块新增类型后未变化的月份编码结果保持不变
+    QVector<int> localIds(256, -1); // CategoryTable编号 -> 文件类型编号
+    QStringList typeTable;
+
+    QByteArray indexBytes;
+    QByteArray slotBytes;
+    indexBytes.reserve(dayCountHint * kIndexEntrySize);
+    slotBytes.reserve(dayCountHint * 8 * kRunSize);
+    quint32 dayCount = 0;
+    source([&](const QDate& date, const DayRecord& record) {
+        const quint32 runOffset = quint32(slotBytes.size());
+        int runCount = 0;
+        for (int slot = 0; slot < DayRecord::kSlotCount;) {
+            const quint8 category = record.categories[slot];
+            if (category == DayRecord::kEmptySlot) {
+                ++slot;
+                continue;
+            }
+            const bool completed = record.isCompleted(slot);
+            int end = slot + 1;
+            while (end < DayRecord::kSlotCount && record.categories[end] == category && record.isCompleted(end) == completed) {
+                ++end;
+            }
+            if (localIds[category] < 0) {
+                localIds[category] = typeTable.size();
+                typeTable.append(CategoryTable::nameOf(category));
+            }
+            put<quint8>(slotBytes, quint8(slot));
+            put<quint8>(slotBytes, quint8(end - slot));
+            put<quint8>(slotBytes, quint8(localIds[category]));
+            put<quint8>(slotBytes, completed ? 1 : 0);
+            ++runCount;
+            slot = end;
+        }
+
+        put<qint32>(indexBytes, qint32(date.toJulianDay()));
+        put<quint32>(indexBytes, runOffset);
+        put<quint16>(indexBytes, record.studyMinutes);
+        put<quint8>(indexBytes, record.completedProjects);
+        put<quint8>(indexBytes, record.totalProjects);
+        put<quint8>(indexBytes, quint8(runCount));
+        put<quint8>(indexBytes, 0);
+        ++dayCount;
+    });
+
+    QByteArray typeBytes;
+    for (const QString& type : std::as_const(typeTable)) {
+        const QByteArray utf8 = type.toUtf8().left(255);
+        put<quint8>(typeBytes, quint8(utf8.size()));
+        typeBytes.append(utf8);
+    }
+
+    const quint32 indexOffset = kFixedHeaderSize + typeBytes.size();
+    const quint32 dataOffset = indexOffset + indexBytes.size();
+
+    QByteArray out;
+    out.reserve(dataOffset + slotBytes.size() + 2);
+    out.append(kMagic, 4);
+    put<quint16>(out, kVersion);
+    put<quint16>(out, 0);
+    put<qint32>(out, maxContinuousDays);
+    put<quint16>(out, quint16(typeTable.size()));
+    put<quint16>(out, 0);
+    put<quint32>(out, dayCount);
+    put<quint32>(out, indexOffset);
+    put<quint32>(out, dataOffset);
+    put<quint32>(out, quint32(slotBytes.size()));
+    out.append(typeBytes);
+    out.append(indexBytes);
+    out.append(slotBytes);
+
+    put<quint16>(out, qChecksum(QByteArrayView(out).sliced(kHeaderSize)));
+    return out;
+}
+
+// 解码二进制格式
+bool StudyCodec::decodeBinary(const QByteArray& data, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString)
+{
+    View view;
+    if (!view.attach(reinterpret_cast<const uchar*>(data.constData()), data.size(), errorString)) {
+        return false;
+    }
+    if (!view.verifyChecksum()) {
+        setError(errorString, "校验失败，数据可能已损坏");
+        return false;
+    }
+
+    for (int i = 0; i < view.dayCount(); ++i) {
+        DayRecord record;
+        if (!view.recordAt(i, record)) {
+            setError(errorString, QString("第%1天的数据已损坏").arg(i + 1));
+            return false;
+        }
+        const QDate date = view.dateAt(i);
+        if (date.isValid()) {
+            visitor(date, record);
+        }
+    }
+
+    maxContinuousDays = view.maxContinuousDays();
+    return true;
+}
+
+// 附加到一段二进制数据
+bool StudyCodec::View::attach(const uchar* data, qint64 size, QString* errorString)
+{
+    detach();
+
+    if (!data || size < kFixedHeaderSize + 2 || memcmp(data, kMagic, 4) != 0) {
+        setError(errorString, "不是有效的二进制存档");
+        return false;
+    }
+    const quint16 version = qFromLittleEndian<quint16>(data + 4);
+    if (version != kVersion) {
+        setError(errorString, QString("不支持的存档版本：%1").arg(version));
+        return false;
+    }
+
+    const qint64 payloadEnd = size - 2;
+    const quint16 typeCount = qFromLittleEndian<quint16>(data + 12);
+    const quint32 dayCount = qFromLittleEndian<quint32>(data + 16);
+    const quint32 indexOffset = qFromLittleEndian<quint32>(data + 20);
+    const quint32 dataOffset = qFromLittleEndian<quint32>(data + 24);
+    const quint32 dataSize = qFromLittleEndian<quint32>(data + 28);
+    if (indexOffset < quint32(kFixedHeaderSize)
+        || qint64(indexOffset) + qint64(dayCount) * kIndexEntrySize != qint64(dataOffset)
+        || qint64(dataOffset) + dataSize != payloadEnd) {
+        setError(errorString, "存档索引越界，数据可能已损坏");
+        return false;
+    }
+
+    Reader reader{data, qint64(indexOffset)};
+    reader.pos = kFixedHeaderSize;
+    QVector<quint8> categoryIds;
+    categoryIds.reserve(typeCount);
+    for (int i = 0; i < typeCount && reader.ok; ++i) {
+        const quint8 len = reader.get<quint8>();
+        categoryIds.append(CategoryTable::idOf(reader.getString(len)));
+    }
+    if (!reader.ok) {
+        setError(errorString, "存档类型表已损坏");
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_dayCount = int(dayCount);
+    m_maxContinuousDays = qFromLittleEndian<qint32>(data + 8);
+    m_indexOffset = indexOffset;
+    m_dataOffset = dataOffset;
+    m_dataSize = dataSize;
+    m_categoryIds = categoryIds;
+    return true;
+}
+
+// 解除附加
+void StudyCodec::View::detach()
+{
+    m_data = nullptr;
+    m_size = 0;
+    m_dayCount = 0;
+    m_maxContinuousDays = 0;
+    m_indexOffset = 0;
+    m_dataOffset = 0;
+    m_dataSize = 0;
+    m_categoryIds.clear();
+}
+
+// 校验整个文件的校验和
+bool StudyCodec::View::verifyChecksum() const
+{
+    if (!m_data) {
+        return false;
+    }
+    const quint16 storedCrc = qFromLittleEndian<quint16>(m_data + m_size - 2);
+    return qChecksum(QByteArrayView(m_data + kHeaderSize, m_size - kHeaderSize - 2)) == storedCrc;
+}
+
+const uchar* StudyCodec::View::entryAt(int index) const
+{
+    return m_data + m_indexOffset + qint64(index) * kIndexEntrySize;
+}
+
+// 第一个不早于指定日期的位置
+int StudyCodec::View::lowerBound(const QDate& date) const
+{
+    const qint64 julianDay = date.toJulianDay();
+    int low = 0;
+    int high = m_dayCount;
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (qFromLittleEndian<qint32>(entryAt(mid)) < julianDay) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// 查找指定日期在索引中的位置
+int StudyCodec::View::indexOf(const QDate& date) const
+{
+    const int index = lowerBound(date);
+    if (index < m_dayCount && qFromLittleEndian<qint32>(entryAt(index)) == date.toJulianDay()) {
+        return index;
+    }
+    return -1;
+}
+
+// 获取指定位置的日期
+QDate StudyCodec::View::dateAt(int index) const
+{
+    return QDate::fromJulianDay(qFromLittleEndian<qint32>(entryAt(index)));
+}
+
+// 读取指定位置的统计字段，不解码时段
+void StudyCodec::View::summaryAt(int index, DayRecord& record) const
+{
+    const uchar* entry = entryAt(index);
+    // 时段越界的日期无法解码，统计按空记录处理，与recordAt()失败时的结果一致
+    if (!runsInBounds(entry)) {
+        record.studyMinutes = 0;
+        record.completedProjects = 0;
+        record.totalProjects = 0;
+        return;
+    }
+    record.studyMinutes = qFromLittleEndian<quint16>(entry + 8);
+    record.completedProjects = entry[10];
+    record.totalProjects = entry[11];
+}
+
+// 检查记录的时段是否位于数据区内
+bool StudyCodec::View::runsInBounds(const uchar* entry) const
+{
+    const quint32 runOffset = qFromLittleEndian<quint32>(entry + 4);
+    const int runCount = entry[12];
+    return qint64(runOffset) + qint64(runCount) * kRunSize <= m_dataSize;
+}
+
+// 完整解码指定位置的单日记录
+bool StudyCodec::View::recordAt(int index, DayRecord& record) const
+{
+    const uchar* entry = entryAt(index);
+    if (!runsInBounds(entry)) {
+        return false;
+    }
+    const quint32 runOffset = qFromLittleEndian<quint32>(entry + 4);
+    const int runCount = entry[12];
+
+    record = DayRecord();
+    const uchar* run = m_data + m_dataOffset + runOffset;
+    for (int r = 0; r < runCount; ++r, run += kRunSize) {
+        if (run[2] >= m_categoryIds.size() || !record.setSlots(run[0], run[1], m_categoryIds[run[2]], run[3] != 0)) {
+            qWarning() << "存档中存在无效的时段：" << run[0] << run[1] << run[2];
+        }
+    }
+    return true;
+}
+
+// 编码为JSON格式（导出用）
+QByteArray StudyCodec::encodeJson(const QMap<QDate, DayRecord>& days, int maxContinuousDays)
+{
+    QJsonObject rootObj;
+    rootObj.insert("maxContinuousDays", maxContinuousDays);
+    QJsonObject dateObj;
+
+    for (auto dateIt = days.constBegin(); dateIt != days.constEnd(); ++dateIt)
+    {
+        const DayRecord& record = dateIt.value();
+
+        // 旧版本读取整数的“studyHours”，继续写出；精确的分钟数作为新增字段
+        QJsonObject studyObj;
+        studyObj.insert("studyHours", record.studyMinutes / 60);
+        studyObj.insert("studyMinutes", record.studyMinutes);
+        studyObj.insert("completedProjects", record.completedProjects);
+        studyObj.insert("totalProjects", record.totalProjects);
+
+        // 每个项目一项：整小时的项目沿用旧版本的“小时”键，其余为“时:分”键并带分钟数
+        QJsonObject timeAxisObj;
+        for (int slot = 0; slot < DayRecord::kSlotCount;)
+        {
+            if (!record.hasSlot(slot)) {
+                ++slot;
+                continue;
+            }
+            int end = slot + 1;
+            while (end < DayRecord::kSlotCount && end % DayRecord::kSlotsPerHour != 0
+                   && record.categoryAt(end) == record.categoryAt(slot) && record.isCompleted(end) == record.isCompleted(slot)) {
+                ++end;
+            }
+            QJsonObject itemObj;
+            itemObj.insert("type", CategoryTable::nameOf(record.categoryAt(slot)));
+            itemObj.insert("isCompleted", record.isCompleted(slot));
+            if (slot % DayRecord::kSlotsPerHour == 0 && end - slot == DayRecord::kSlotsPerHour) {
+                timeAxisObj.insert(QString::number(slot / DayRecord::kSlotsPerHour), itemObj);
+            } else {
+                itemObj.insert("minutes", (end - slot) * DayRecord::kSlotMinutes);
+                timeAxisObj.insert(DayRecord::slotLabel(slot), itemObj);
+            }
+            slot = end;
+        }
+        studyObj.insert("timeAxisData", timeAxisObj);
+        dateObj.insert(dateIt.key().toString("yyyy-MM-dd"), studyObj);
+    }
+    rootObj.insert("studyData", dateObj);
+
+    return QJsonDocument(rootObj).toJson(QJsonDocument::Compact);
+}
+
+// 解码JSON格式（导入用），流式读取，损坏的日期跳过
+bool StudyCodec::decodeJson(const QByteArray& data, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString)
+{
+    StudyJsonReader reader(data.constData(), data.size());
+    if (!reader.read(visitor)) {
+        setError(errorString, reader.errorString());
+        return false;
+    }
+
+    if (!reader.issues().isEmpty()) {
+        qWarning() << "JSON数据中有" << reader.issues().size() << "处损坏已跳过，成功读取" << reader.dayCount() << "天";
+    }
+    if (reader.hasMaxContinuousDays()) {
+        maxContinuousDays = reader.maxContinuousDays();
+    }
+    return true;
+}
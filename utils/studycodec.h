@@ -0,0 +1,155 @@
+#ifndef STUDYCODEC_H
+#define STUDYCODEC_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The StudyCodec class
+ * 学习数据的统一编解码器，存档、日志与备份都经由此处读写。
+ * 默认使用带版本号的紧凑二进制格式：日期存为儒略日整数，时段存为单字节的15分钟序号，
+ * 事项类型存为字符串表中的驻留编号（与CategoryTable的编号一致）；JSON仅作为导入导出格式保留。
+ * 解码时根据文件头自动识别二进制或JSON，JSON由StudyJsonReader流式读取。
+ * 二进制格式带有按日期排序的索引，可通过View直接在内存映射上按天随机解码。
+ */
+class StudyCodec
+{
+public:
+    // 编码格式
+    enum Format {
+        Binary, // 紧凑二进制格式
+        Json    // 兼容旧版本的JSON格式
+    };
+
+    // 逐天接收解码结果的访问者
+    using DayVisitor = std::function<void(const QDate&, const DayRecord&)>;
+
+    // 按日期顺序逐天把记录交给访问者的数据源
+    using DaySource = std::function<void(const DayVisitor&)>;
+
+    // 二进制格式版本（带日期索引、按15分钟时段游程存放），只读写这一个版本
+    static const quint16 kVersion = 3;
+
+    /**
+     * @brief The View class
+     * 二进制存档的只读视图，不拷贝数据。
+     * 打开时只校验文件头与索引边界，之后通过二分查找索引按天解码，
+     * 每天的学习时长与项目数直接存放在索引中，统计时无需解码时间轴数据。
+     */
+    class View
+    {
+    public:
+        // 附加到一段二进制数据，数据须在视图使用期间保持有效
+        // 参数1：数据起始地址
+        // 参数2：数据长度
+        // 参数3：输出，错误信息
+        // 返回：是否为有效的二进制存档
+        bool attach(const uchar* data, qint64 size, QString* errorString = nullptr);
+
+        // 解除附加
+        void detach();
+
+        // 是否已附加
+        bool isValid() const {return m_data != nullptr;}
+
+        // 校验整个文件的校验和（需要遍历全部数据）
+        bool verifyChecksum() const;
+
+        // 获取天数
+        int dayCount() const {return m_dayCount;}
+
+        // 获取最大连续天数
+        int maxContinuousDays() const {return m_maxContinuousDays;}
+
+        // 查找指定日期在索引中的位置
+        // 返回：位置，不存在时返回-1
+        int indexOf(const QDate& date) const;
+
+        // 第一个不早于指定日期的位置
+        int lowerBound(const QDate& date) const;
+
+        // 获取指定位置的日期
+        QDate dateAt(int index) const;
+
+        // 读取指定位置的统计字段（学习分钟数、完成数、总数），不解码时段
+        // 时段已损坏的记录按空记录处理，统计为零
+        void summaryAt(int index, DayRecord& record) const;
+
+        // 完整解码指定位置的单日记录
+        // 返回：是否成功
+        bool recordAt(int index, DayRecord& record) const;
+
+    private:
+        const uchar* entryAt(int index) const;
+        bool runsInBounds(const uchar* entry) const;
+
+    private:
+        const uchar* m_data = nullptr;
+        qint64 m_size = 0;
+        int m_dayCount = 0;
+        int m_maxContinuousDays = 0;
+        quint32 m_indexOffset = 0;
+        quint32 m_dataOffset = 0;
+        quint32 m_dataSize = 0;
+        QVector<quint8> m_categoryIds; // 文件类型编号 -> CategoryTable编号
+    };
+
+public:
+    // 编码学习数据
+    // 参数1：按日期索引的单日记录
+    // 参数2：最大连续天数
+    // 参数3：编码格式
+    // 返回：编码后的字节
+    static QByteArray encode(const QMap<QDate, DayRecord>& days, int maxContinuousDays, Format format = Binary);
+
+    // 把修改过的日期合并进已有的二进制存档，逐天重新编码，不构建完整数据的中间容器
+    // 参数1：已有存档的视图，无效时只编码修改过的日期
+    // 参数2：修改过的日期，与存档中同一天的记录冲突时以此为准
+    // 参数3：最大连续天数
+    // 返回：二进制格式的字节
+    static QByteArray encodeMerged(const View& base, const QMap<QDate, DayRecord>& changes, int maxContinuousDays);
+
+    // 解码学习数据，自动识别格式
+    // 参数1：待解码字节
+    // 参数2：输出，按日期索引的单日记录
+    // 参数3：输出，最大连续天数（数据中没有时保持不变）
+    // 参数4：输出，错误信息
+    // 返回：是否成功
+    static bool decode(const QByteArray& data, QMap<QDate, DayRecord>& days, int& maxContinuousDays, QString* errorString = nullptr);
+
+    // 解码学习数据，逐天交给访问者，不构建中间容器
+    // 参数1：待解码字节
+    // 参数2：访问者
+    // 参数3：输出，最大连续天数（数据中没有时保持不变）
+    // 参数4：输出，错误信息
+    // 返回：是否成功，失败时访问者可能已收到部分日期
+    static bool decode(const QByteArray& data, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString = nullptr);
+
+    // 以内存映射方式读取文件并解码，逐天交给访问者
+    // 参数1：文件路径
+    // 参数2：访问者
+    // 参数3：输出，最大连续天数（数据中没有时保持不变）
+    // 参数4：输出，错误信息
+    // 返回：是否成功，失败时访问者可能已收到部分日期
+    static bool decodeFile(const QString& path, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString = nullptr);
+
+    // 判断字节是否为二进制格式
+    static bool isBinary(const QByteArray& data);
+
+    // 根据文件后缀推断编码格式，.json为JSON，其余为二进制
+    static Format formatForPath(const QString& path);
+
+private:
+    static QByteArray encodeBinary(const DaySource& source, int dayCountHint, int maxContinuousDays);
+    static QByteArray encodeJson(const QMap<QDate, DayRecord>& days, int maxContinuousDays);
+    static bool decodeBinary(const QByteArray& data, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString);
+    static bool decodeJson(const QByteArray& data, const DayVisitor& visitor, int& maxContinuousDays, QString* errorString);
+};
+
+#endif // STUDYCODEC_H
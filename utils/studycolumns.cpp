@@ -0,0 +1,66 @@
+#include "studycolumns.h"
+#include <QtAlgorithms>
+
+// 写入某一天的统计字段
+void StudyColumns::setDay(const QDate& date, const DayRecord& record)
+{
+    if (!date.isValid()) {
+        return;
+    }
+    YearChunk& chunk = m_chunks[date.year()];
+    const int day = date.dayOfYear() - 1;
+    chunk.studyMinutes[day] = record.studyMinutes;
+    chunk.completedProjects[day] = record.completedProjects;
+    chunk.totalProjects[day] = record.totalProjects;
+    chunk.presence[day / 32] |= 1u << (day % 32);
+}
+
+// 统计日期区间内的数据
+StudyColumns::Totals StudyColumns::totals(const QDate& from, const QDate& to) const
+{
+    Totals result;
+    auto it = from.isValid() ? m_chunks.lowerBound(from.year()) : m_chunks.constBegin();
+    for (; it != m_chunks.constEnd(); ++it) {
+        const int year = it.key();
+        if (to.isValid() && year > to.year()) {
+            break;
+        }
+        const int first = (from.isValid() && year == from.year()) ? from.dayOfYear() - 1 : 0;
+        const int last = (to.isValid() && year == to.year()) ? to.dayOfYear() - 1 : YearChunk::kDays - 1;
+        if (first <= last) {
+            accumulate(it.value(), first, last, result);
+        }
+    }
+    return result;
+}
+
+// 统计单个分块中[first, last]天序号范围内的数据
+void StudyColumns::accumulate(const YearChunk& chunk, int first, int last, Totals& totals)
+{
+    // 不存在的日期各列均为0，直接对连续切片求和
+    int studyMinutes = 0;
+    int completedProjects = 0;
+    int totalProjects = 0;
+    for (int day = first; day <= last; ++day) {
+        studyMinutes += chunk.studyMinutes[day];
+        completedProjects += chunk.completedProjects[day];
+        totalProjects += chunk.totalProjects[day];
+    }
+    totals.studyMinutes += studyMinutes;
+    totals.completedProjects += completedProjects;
+    totals.totalProjects += totalProjects;
+
+    // 位图按32天一组计数，首尾两组用掩码截取
+    const int firstWord = first / 32;
+    const int lastWord = last / 32;
+    for (int word = firstWord; word <= lastWord; ++word) {
+        quint32 bits = chunk.presence[word];
+        if (word == firstWord) {
+            bits &= ~0u << (first % 32);
+        }
+        if (word == lastWord && last % 32 != 31) {
+            bits &= (1u << (last % 32 + 1)) - 1;
+        }
+        totals.days += qPopulationCount(bits);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef STUDYCOLUMNS_H
+#define STUDYCOLUMNS_H
+
+#include <QDate>
+#include <QMap>
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The StudyColumns class
+ * 按列存放的学习统计，每年一个分块。
+ * 分块内学习分钟数、完成数、总数各是一段按年内天序号索引的定长数组，
+ * 另有一张位图记录哪些天存在数据；区间统计只是对数组切片的顺序求和。
+ */
+class StudyColumns
+{
+public:
+    // 区间统计结果
+    struct Totals
+    {
+        int days = 0;              // 存在数据的天数
+        int studyMinutes = 0;      // 学习分钟数
+        int completedProjects = 0; // 完成项目数
+        int totalProjects = 0;     // 总项目数
+    };
+
+    // 单年分块
+    struct YearChunk
+    {
+        static constexpr int kDays = 366;
+        static constexpr int kPresenceWords = (kDays + 31) / 32;
+
+        quint16 studyMinutes[kDays] = {};
+        quint8 completedProjects[kDays] = {};
+        quint8 totalProjects[kDays] = {};
+        quint32 presence[kPresenceWords] = {};
+    };
+
+public:
+    // 清空全部分块
+    void clear(){m_chunks.clear();}
+
+    // 清空指定年份的分块
+    void clearYear(int year){m_chunks.remove(year);}
+
+    // 写入某一天的统计字段
+    // 参数1：日期
+    // 参数2：单日记录（只使用统计字段）
+    void setDay(const QDate& date, const DayRecord& record);
+
+    // 统计日期区间内的数据
+    // 参数1：起始日期（含），无效时从最早的数据开始
+    // 参数2：结束日期（含），无效时到最晚的数据为止
+    // 返回：区间统计结果
+    Totals totals(const QDate& from = QDate(), const QDate& to = QDate()) const;
+
+private:
+    // 统计单个分块中[first, last]天序号范围内的数据
+    static void accumulate(const YearChunk& chunk, int first, int last, Totals& totals);
+
+private:
+    QMap<int, YearChunk> m_chunks;
+};
+
+#endif // STUDYCOLUMNS_H
@@ -0,0 +1,275 @@
+#include "studyjournal.h"
+#include "utils/dayrecord.h"
+#include <QDataStream>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+const char kJournalMagic[4] = {'P', 'T', 'J', '2'};
+const int kJournalHeaderSize = 4;
+
+// 将文件缓冲写入磁盘
+bool syncFile(QFile& file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+}
+
+StudyJournal::StudyJournal() {}
+
+StudyJournal::~StudyJournal()
+{
+    close();
+}
+
+// 打开日志文件（不存在则创建），并定位到末尾
+bool StudyJournal::open(const QString& path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qCritical() << "无法打开学习数据日志：" << path << "，错误：" << m_file.errorString();
+        return false;
+    }
+
+    if (m_file.size() < kJournalHeaderSize) {
+        m_file.resize(0);
+        if (!writeHeader()) {
+            m_file.close();
+            return false;
+        }
+    } else {
+        m_file.seek(0);
+        const QByteArray header = m_file.read(kJournalHeaderSize);
+        if (header != QByteArray(kJournalMagic, kJournalHeaderSize)) {
+            qWarning() << "学习数据日志文件头无效，已重置：" << path;
+            m_file.resize(0);
+            if (!writeHeader()) {
+                m_file.close();
+                return false;
+            }
+        }
+    }
+
+    m_file.seek(m_file.size());
+    m_entryCount = 0;
+    m_pendingSync = 0;
+    m_lastSync.start();
+    return true;
+}
+
+// 关闭日志文件，关闭前刷盘
+void StudyJournal::close()
+{
+    if (m_file.isOpen()) {
+        sync();
+        m_file.close();
+    }
+}
+
+// 读取日志中所有完整的记录，残缺的尾部会被截断
+QList<StudyJournal::Entry> StudyJournal::readAll()
+{
+    QList<Entry> entries;
+    if (!m_file.isOpen()) {
+        return entries;
+    }
+
+    m_file.seek(kJournalHeaderSize);
+    const QByteArray data = m_file.readAll();
+    qint64 pos = 0;
+    qint64 validEnd = 0;
+
+    while (pos + 2 <= data.size()) {
+        const quint16 len = quint16(uchar(data[pos])) | (quint16(uchar(data[pos + 1])) << 8);
+        if (pos + 2 + len + 2 > data.size()) {
+            break;
+        }
+        const QByteArray payload = data.mid(pos + 2, len);
+        const quint16 crc = quint16(uchar(data[pos + 2 + len])) | (quint16(uchar(data[pos + 3 + len])) << 8);
+        if (qChecksum(payload) != crc) {
+            qWarning() << "学习数据日志在偏移" << kJournalHeaderSize + pos << "处校验失败，丢弃后续记录";
+            break;
+        }
+        Entry entry;
+        if (!decodeEntry(payload, entry)) {
+            qWarning() << "学习数据日志在偏移" << kJournalHeaderSize + pos << "处记录无法解析，丢弃后续记录";
+            break;
+        }
+        entries.append(entry);
+        pos += 2 + len + 2;
+        validEnd = pos;
+    }
+
+    if (validEnd != data.size()) {
+        qWarning() << "学习数据日志尾部残缺，截断" << data.size() - validEnd << "字节";
+        m_file.resize(kJournalHeaderSize + validEnd);
+    }
+
+    m_file.seek(m_file.size());
+    m_entryCount = entries.size();
+    return entries;
+}
+
+// 追加一条记录，达到批次大小或时间间隔后刷盘
+bool StudyJournal::append(const Entry& entry)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    const QByteArray payload = encodeEntry(entry);
+    const quint16 len = quint16(payload.size());
+    const quint16 crc = qChecksum(payload);
+
+    QByteArray record;
+    record.reserve(payload.size() + 4);
+    record.append(char(len & 0xFF)).append(char(len >> 8));
+    record.append(payload);
+    record.append(char(crc & 0xFF)).append(char(crc >> 8));
+
+    if (m_file.write(record) != record.size() || !m_file.flush()) {
+        qCritical() << "学习数据日志写入失败：" << m_file.errorString();
+        return false;
+    }
+
+    ++m_entryCount;
+    ++m_pendingSync;
+    if (m_pendingSync >= m_syncBatchSize || m_lastSync.elapsed() >= m_syncIntervalMs) {
+        return sync();
+    }
+    return true;
+}
+
+// 立即刷盘
+bool StudyJournal::sync()
+{
+    if (!m_file.isOpen() || m_pendingSync == 0) {
+        return true;
+    }
+    if (!syncFile(m_file)) {
+        qCritical() << "学习数据日志刷盘失败：" << m_file.fileName();
+        return false;
+    }
+    m_pendingSync = 0;
+    m_lastSync.restart();
+    return true;
+}
+
+// 清空日志（存档压缩完成后调用）
+bool StudyJournal::reset()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    if (!m_file.resize(kJournalHeaderSize)) {
+        qCritical() << "清空学习数据日志失败：" << m_file.errorString();
+        return false;
+    }
+    m_file.seek(kJournalHeaderSize);
+    m_entryCount = 0;
+    m_pendingSync = 1;
+    return sync();
+}
+
+// 写入文件头
+bool StudyJournal::writeHeader()
+{
+    m_file.seek(0);
+    if (m_file.write(kJournalMagic, kJournalHeaderSize) != kJournalHeaderSize) {
+        qCritical() << "学习数据日志文件头写入失败：" << m_file.errorString();
+        return false;
+    }
+    m_pendingSync = 1;
+    return sync();
+}
+
+// 编码单条记录
+QByteArray StudyJournal::encodeEntry(const Entry& entry)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(entry.op) << qint64(entry.date.toJulianDay()) << quint8(entry.slot) << quint8(entry.slotCount);
+    if (entry.op == SetItem) {
+        out << entry.item.type << entry.item.isCompleted;
+    } else if (entry.op == ApplyTemplate) {
+        // 模板按连续的同类时段存放：[结束儒略日i64][星期掩码u8][段数u8]{[时段u8][时段数u8][类型][完成]}...
+        const DayRecord& record = entry.dayTemplate;
+        QList<QPair<int, int>> runs;
+        for (int slot = 0; slot < DayRecord::kSlotCount;) {
+            if (!record.hasSlot(slot)) {
+                ++slot;
+                continue;
+            }
+            int end = slot + 1;
+            while (end < DayRecord::kSlotCount && record.categoryAt(end) == record.categoryAt(slot)
+                   && record.isCompleted(end) == record.isCompleted(slot)) {
+                ++end;
+            }
+            runs.append({slot, end - slot});
+            slot = end;
+        }
+        out << qint64(entry.endDate.toJulianDay()) << quint8(entry.weekdayMask) << quint8(runs.size());
+        for (const QPair<int, int>& run : std::as_const(runs)) {
+            out << quint8(run.first) << quint8(run.second) << CategoryTable::nameOf(record.categoryAt(run.first)) << record.isCompleted(run.first);
+        }
+    }
+    return payload;
+}
+
+// 解码单条记录负载
+bool StudyJournal::decodeEntry(const QByteArray& payload, Entry& entry)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint8 op = 0;
+    qint64 julianDay = 0;
+    in >> op >> julianDay;
+    if (op < SetItem || op > ApplyTemplate) {
+        return false;
+    }
+    entry.op = OpType(op);
+    entry.date = QDate::fromJulianDay(julianDay);
+    quint8 slot = 0;
+    quint8 slotCount = 0;
+    in >> slot >> slotCount;
+    entry.slot = slot;
+    entry.slotCount = slotCount;
+    if (entry.op == SetItem) {
+        in >> entry.item.type >> entry.item.isCompleted;
+    } else if (entry.op == ApplyTemplate) {
+        qint64 endJulianDay = 0;
+        quint8 weekdayMask = 0;
+        quint8 runCount = 0;
+        in >> endJulianDay >> weekdayMask >> runCount;
+        entry.endDate = QDate::fromJulianDay(endJulianDay);
+        entry.weekdayMask = weekdayMask;
+        entry.dayTemplate = DayRecord();
+        for (int i = 0; i < runCount && in.status() == QDataStream::Ok; ++i) {
+            quint8 slot = 0;
+            quint8 slotCount = 0;
+            TimeAxisItem item;
+            in >> slot >> slotCount >> item.type >> item.isCompleted;
+            if (!entry.dayTemplate.setSlots(slot, slotCount, CategoryTable::idOf(item.type), item.isCompleted)) {
+                return false;
+            }
+        }
+        if (!entry.endDate.isValid()) {
+            return false;
+        }
+    }
+    return in.status() == QDataStream::Ok && entry.date.isValid();
+}
@@ -0,0 +1,108 @@
+#ifndef STUDYJOURNAL_H
+#define STUDYJOURNAL_H
+
+#include <QFile>
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <QElapsedTimer>
+#include "datastruct.h"
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The StudyJournal class
+ * 学习数据的预写日志（追加写）。
+ * 每次时间轴编辑只追加一条按时段的变更记录，而不是重写整个存档，
+ * 记录按批次刷盘（fsync），并由AppDatas定期压缩回存档文件。
+ * 记录格式：[长度u16][负载][校验u16]，重放时遇到残缺或校验失败的尾部即停止并截断。
+ */
+class StudyJournal
+{
+public:
+    // 变更类型
+    enum OpType : quint8 {
+        SetItem = 1,    // 设置连续若干时段的事项
+        RemoveItem = 2, // 清除连续若干时段的事项
+        ClearDate = 3,    // 清空某一天
+        ApplyTemplate = 4 // 把模板套用到日期区间内的指定星期
+    };
+
+    // 单条变更记录
+    struct Entry
+    {
+        OpType op = SetItem;
+        QDate date;
+        int slot = 0;      // 第一个15分钟时段的序号
+        int slotCount = 1; // 时段数
+        TimeAxisItem item;
+        quint8 category = 0xFF; // 编辑时已知的类型编号，从日志读取时无效，按item.type解析
+        QDate endDate;          // ApplyTemplate：结束日期（含）
+        int weekdayMask = 0;    // ApplyTemplate：星期掩码，周一为第0位
+        DayRecord dayTemplate;  // ApplyTemplate：模板记录，日志中按类型名称保存
+    };
+
+public:
+    StudyJournal();
+    ~StudyJournal();
+
+    // 打开日志文件（不存在则创建），并定位到末尾
+    // 参数1：日志文件路径
+    // 返回：是否成功
+    bool open(const QString& path);
+
+    // 关闭日志文件，关闭前刷盘
+    void close();
+
+    // 读取日志中所有完整的记录，残缺的尾部会被截断
+    // 返回：按写入顺序排列的记录
+    QList<Entry> readAll();
+
+    // 追加一条记录，达到批次大小或时间间隔后刷盘
+    // 参数1：变更记录
+    // 返回：是否成功
+    bool append(const Entry& entry);
+
+    // 立即刷盘
+    // 返回：是否成功
+    bool sync();
+
+    // 清空日志（存档压缩完成后调用）
+    // 返回：是否成功
+    bool reset();
+
+    // 设置刷盘批次大小
+    // 参数1：累计多少条记录后刷盘
+    void setSyncBatchSize(int size){m_syncBatchSize = qMax(1, size);}
+
+    // 设置刷盘最大间隔
+    // 参数1：毫秒数
+    void setSyncInterval(int ms){m_syncIntervalMs = ms;}
+
+    // 获取当前日志中的记录数
+    int entryCount() const {return m_entryCount;}
+
+    // 是否已打开
+    bool isOpen() const {return m_file.isOpen();}
+
+private:
+    // 写入文件头
+    bool writeHeader();
+
+    // 编码单条记录
+    static QByteArray encodeEntry(const Entry& entry);
+
+    // 解码单条记录负载
+    // 参数1：负载
+    // 参数2：输出，变更记录
+    static bool decodeEntry(const QByteArray& payload, Entry& entry);
+
+private:
+    QFile m_file;
+    int m_entryCount = 0;
+    int m_pendingSync = 0;
+    int m_syncBatchSize = 16;
+    int m_syncIntervalMs = 2000;
+    QElapsedTimer m_lastSync;
+};
+
+#endif // STUDYJOURNAL_H
@@ -0,0 +1,447 @@
+#include "studyjsonreader.h"
+#include <QByteArray>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+}
+
+StudyJsonReader::StudyJsonReader(const char* data, qint64 size)
+    : m_data(data)
+    , m_size(size)
+{
+    // 跳过UTF-8 BOM
+    if (m_size >= 3 && uchar(m_data[0]) == 0xEF && uchar(m_data[1]) == 0xBB && uchar(m_data[2]) == 0xBF) {
+        m_pos = 3;
+    }
+}
+
+// 读取全部日期
+bool StudyJsonReader::read(const DayVisitor& visitor)
+{
+    if (!consume('{')) {
+        return fail("根节点不是JSON对象");
+    }
+
+    bool foundStudyData = false;
+    if (!consume('}')) {
+        while (true) {
+            QString key;
+            if (!readString(&key) || !consume(':')) {
+                return fail("根对象中的字段名无效");
+            }
+
+            if (key == "studyData") {
+                if (!readStudyData(visitor)) {
+                    return false;
+                }
+                foundStudyData = true;
+            } else if (key == "maxContinuousDays") {
+                skipWhitespace();
+                const qint64 valuePos = m_pos;
+                double value = 0;
+                if (readNumber(value)) {
+                    m_maxContinuousDays = int(value);
+                    m_hasMaxContinuousDays = true;
+                } else {
+                    addIssue(valuePos, "最大连续天数不是数字");
+                    m_pos = valuePos;
+                    if (!skipValue()) {
+                        return fail("数据被截断");
+                    }
+                }
+            } else if (!skipValue()) {
+                return fail("数据被截断");
+            }
+
+            if (consume(',')) {
+                continue;
+            }
+            if (consume('}')) {
+                break;
+            }
+            return fail("根对象中缺少逗号或右括号");
+        }
+    }
+
+    if (!foundStudyData) {
+        m_errorString = "没有studyData字段";
+        return false;
+    }
+    return true;
+}
+
+// 读取studyData对象，逐天交给访问者
+bool StudyJsonReader::readStudyData(const DayVisitor& visitor)
+{
+    if (!consume('{')) {
+        return fail("studyData不是JSON对象");
+    }
+    if (consume('}')) {
+        return true;
+    }
+
+    while (true) {
+        skipWhitespace();
+        const qint64 dayPos = m_pos;
+        QString key;
+        if (!readString(&key) || !consume(':')) {
+            addIssue(dayPos, "日期字段名无效，已跳过");
+            m_pos = dayPos;
+            if (!skipValue()) {
+                return fail("数据被截断");
+            }
+        } else {
+            skipWhitespace();
+            const qint64 valuePos = m_pos;
+            const QDate date = parseDate(key);
+            DayRecord record;
+            if (!date.isValid()) {
+                addIssue(dayPos, QString("无效的日期格式：%1，已跳过").arg(key));
+                if (!skipValue()) {
+                    return fail("数据被截断");
+                }
+            } else if (!readDay(record, key)) {
+                addIssue(m_pos, QString("%1的数据已损坏，已跳过").arg(key));
+                m_pos = valuePos;
+                if (!skipValue()) {
+                    return fail("数据被截断");
+                }
+            } else {
+                visitor(date, record);
+                ++m_dayCount;
+            }
+        }
+
+        if (consume(',')) {
+            continue;
+        }
+        if (consume('}')) {
+            return true;
+        }
+        return fail("studyData中缺少逗号或右括号");
+    }
+}
+
+// 读取单日对象，统计字段由时段重新计算，不读取JSON中的值
+bool StudyJsonReader::readDay(DayRecord& record, const QString& dateKey)
+{
+    if (!consume('{')) {
+        return false;
+    }
+    if (consume('}')) {
+        return true;
+    }
+
+    while (true) {
+        QString key;
+        if (!readString(&key) || !consume(':')) {
+            return false;
+        }
+        if (key == "timeAxisData") {
+            if (!readTimeAxis(record, dateKey)) {
+                return false;
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+
+        if (consume(',')) {
+            continue;
+        }
+        return consume('}');
+    }
+}
+
+// 读取时间轴对象
+bool StudyJsonReader::readTimeAxis(DayRecord& record, const QString& dateKey)
+{
+    if (!consume('{')) {
+        return false;
+    }
+    if (consume('}')) {
+        return true;
+    }
+
+    while (true) {
+        skipWhitespace();
+        const qint64 itemPos = m_pos;
+        QString slotKey;
+        if (!readString(&slotKey) || !consume(':')) {
+            return false;
+        }
+
+        // 旧版本只有整小时，缺少分钟数时按一小时处理
+        QString type;
+        bool isCompleted = false;
+        int minutes = 60;
+        if (!readItem(type, isCompleted, minutes)) {
+            return false;
+        }
+
+        // 键为“小时”或“时:分”
+        const QStringList parts = slotKey.split(':');
+        bool hourOk = false;
+        bool minuteOk = parts.size() == 1;
+        const int hour = parts[0].toInt(&hourOk);
+        const int minute = parts.size() == 2 ? parts[1].toInt(&minuteOk) : 0;
+        const bool ok = hourOk && minuteOk && parts.size() <= 2 && minute >= 0 && minute < 60
+                        && minute % DayRecord::kSlotMinutes == 0 && minutes % DayRecord::kSlotMinutes == 0;
+        if (!ok || !record.setSlots(DayRecord::slotOf(hour, minute), minutes / DayRecord::kSlotMinutes, CategoryTable::idOf(type), isCompleted)) {
+            addIssue(itemPos, QString("%1中无法导入的时段：%2，已忽略").arg(dateKey, slotKey));
+        }
+
+        if (consume(',')) {
+            continue;
+        }
+        return consume('}');
+    }
+}
+
+// 读取单个事项对象
+bool StudyJsonReader::readItem(QString& type, bool& isCompleted, int& minutes)
+{
+    if (!consume('{')) {
+        return false;
+    }
+    if (consume('}')) {
+        return true;
+    }
+
+    while (true) {
+        QString key;
+        if (!readString(&key) || !consume(':')) {
+            return false;
+        }
+        if (key == "type") {
+            if (!readString(&type)) {
+                return false;
+            }
+        } else if (key == "isCompleted") {
+            if (!readBool(isCompleted)) {
+                return false;
+            }
+        } else if (key == "minutes") {
+            double value = 0;
+            if (!readNumber(value)) {
+                return false;
+            }
+            minutes = int(value);
+        } else if (!skipValue()) {
+            return false;
+        }
+
+        if (consume(',')) {
+            continue;
+        }
+        return consume('}');
+    }
+}
+
+// 跳过空白字符
+void StudyJsonReader::skipWhitespace()
+{
+    while (m_pos < m_size && isSpace(m_data[m_pos])) {
+        ++m_pos;
+    }
+}
+
+// 跳过空白后读取指定字符
+bool StudyJsonReader::consume(char c)
+{
+    skipWhitespace();
+    if (m_pos < m_size && m_data[m_pos] == c) {
+        ++m_pos;
+        return true;
+    }
+    return false;
+}
+
+// 读取字符串，未转义的片段直接按UTF-8转换
+// 参数1：输出，为nullptr时只校验不转换
+bool StudyJsonReader::readString(QString* out)
+{
+    skipWhitespace();
+    if (m_pos >= m_size || m_data[m_pos] != '"') {
+        return false;
+    }
+    ++m_pos;
+
+    QString result;
+    qint64 segment = m_pos;
+    while (m_pos < m_size) {
+        const char c = m_data[m_pos];
+        if (c == '"') {
+            if (out) {
+                result += QString::fromUtf8(m_data + segment, m_pos - segment);
+                *out = result;
+            }
+            ++m_pos;
+            return true;
+        }
+        if (uchar(c) < 0x20) {
+            return false;
+        }
+        if (c != '\\') {
+            ++m_pos;
+            continue;
+        }
+
+        if (out) {
+            result += QString::fromUtf8(m_data + segment, m_pos - segment);
+        }
+        if (m_pos + 1 >= m_size) {
+            return false;
+        }
+        const char escape = m_data[m_pos + 1];
+        m_pos += 2;
+        QChar decoded;
+        switch (escape) {
+        case '"':  decoded = '"'; break;
+        case '\\': decoded = '\\'; break;
+        case '/':  decoded = '/'; break;
+        case 'b':  decoded = '\b'; break;
+        case 'f':  decoded = '\f'; break;
+        case 'n':  decoded = '\n'; break;
+        case 'r':  decoded = '\r'; break;
+        case 't':  decoded = '\t'; break;
+        case 'u': {
+            if (m_pos + 4 > m_size) {
+                return false;
+            }
+            bool ok = false;
+            const ushort code = QByteArray::fromRawData(m_data + m_pos, 4).toUShort(&ok, 16);
+            if (!ok) {
+                return false;
+            }
+            // 代理对的两半分别追加，组合后即为完整字符
+            decoded = QChar(code);
+            m_pos += 4;
+            break;
+        }
+        default:
+            return false;
+        }
+        if (out) {
+            result += decoded;
+        }
+        segment = m_pos;
+    }
+    return false;
+}
+
+// 读取数字
+bool StudyJsonReader::readNumber(double& value)
+{
+    skipWhitespace();
+    const qint64 start = m_pos;
+    while (m_pos < m_size) {
+        const char c = m_data[m_pos];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            ++m_pos;
+        } else {
+            break;
+        }
+    }
+    if (m_pos == start) {
+        return false;
+    }
+    bool ok = false;
+    value = QByteArray::fromRawData(m_data + start, int(m_pos - start)).toDouble(&ok);
+    return ok;
+}
+
+// 读取布尔值，兼容以0/1表示的旧数据
+bool StudyJsonReader::readBool(bool& value)
+{
+    skipWhitespace();
+    if (m_size - m_pos >= 4 && memcmp(m_data + m_pos, "true", 4) == 0) {
+        value = true;
+        m_pos += 4;
+        return true;
+    }
+    if (m_size - m_pos >= 5 && memcmp(m_data + m_pos, "false", 5) == 0) {
+        value = false;
+        m_pos += 5;
+        return true;
+    }
+    double number = 0;
+    if (readNumber(number)) {
+        value = number != 0;
+        return true;
+    }
+    return false;
+}
+
+// 跳过一个值，只按引号与括号深度扫描，不校验内容
+// 停在同层的逗号或右括号上，返回false表示已到数据末尾
+bool StudyJsonReader::skipValue()
+{
+    skipWhitespace();
+    int depth = 0;
+    while (m_pos < m_size) {
+        const char c = m_data[m_pos];
+        if (c == '"') {
+            ++m_pos;
+            while (m_pos < m_size && m_data[m_pos] != '"') {
+                m_pos += m_data[m_pos] == '\\' ? 2 : 1;
+            }
+            ++m_pos;
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) {
+                return true;
+            }
+            if (--depth == 0) {
+                ++m_pos;
+                return true;
+            }
+        } else if (c == ',' && depth == 0) {
+            return true;
+        }
+        ++m_pos;
+    }
+    return false;
+}
+
+// 解析yyyy-MM-dd格式的日期，不分配中间字符串
+QDate StudyJsonReader::parseDate(const QString& text)
+{
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') {
+        return QDate();
+    }
+    int parts[3] = {0, 0, 0};
+    const int starts[3] = {0, 5, 8};
+    const int lengths[3] = {4, 2, 2};
+    for (int p = 0; p < 3; ++p) {
+        for (int i = starts[p]; i < starts[p] + lengths[p]; ++i) {
+            const QChar ch = text[i];
+            if (ch.unicode() < '0' || ch.unicode() > '9') {
+                return QDate();
+            }
+            parts[p] = parts[p] * 10 + (ch.unicode() - '0');
+        }
+    }
+    return QDate(parts[0], parts[1], parts[2]);
+}
+
+// 记录一处损坏
+void StudyJsonReader::addIssue(qint64 offset, const QString& message)
+{
+    m_issues.append({offset, message});
+    qWarning() << "JSON数据在偏移" << offset << "处损坏：" << message;
+}
+
+// 记录整体失败
+bool StudyJsonReader::fail(const QString& message)
+{
+    m_errorString = QString("偏移%1处：%2").arg(m_pos).arg(message);
+    return false;
+}
@@ -0,0 +1,85 @@
+#ifndef STUDYJSONREADER_H
+#define STUDYJSONREADER_H
+
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <functional>
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The StudyJsonReader class
+ * 旧版JSON存档、日志与备份的流式读取器。
+ * 直接在原始字节上逐个记号扫描，每解析完一天就交给访问者，不构建QJsonDocument；
+ * 某一天的数据损坏时只跳过这一天并记录损坏位置的字节偏移，其余日期照常读取。
+ * 只有根对象或studyData对象本身的结构无法识别时才整体失败。
+ */
+class StudyJsonReader
+{
+public:
+    // 损坏记录
+    struct Issue
+    {
+        qint64 offset = 0; // 相对数据开头的字节偏移
+        QString message;
+    };
+
+    // 访问者，每解析完一天调用一次
+    using DayVisitor = std::function<void(const QDate&, const DayRecord&)>;
+
+public:
+    // 参数1：数据起始地址，须在读取期间保持有效
+    // 参数2：数据长度
+    StudyJsonReader(const char* data, qint64 size);
+
+    // 读取全部日期
+    // 参数1：访问者
+    // 返回：是否成功，失败时访问者可能已收到部分日期
+    bool read(const DayVisitor& visitor);
+
+    // 数据中是否包含最大连续天数
+    bool hasMaxContinuousDays() const {return m_hasMaxContinuousDays;}
+
+    // 获取最大连续天数
+    int maxContinuousDays() const {return m_maxContinuousDays;}
+
+    // 获取成功读取的天数
+    int dayCount() const {return m_dayCount;}
+
+    // 获取读取过程中发现的损坏
+    const QList<Issue>& issues() const {return m_issues;}
+
+    // 获取导致整体失败的错误信息
+    QString errorString() const {return m_errorString;}
+
+private:
+    bool readStudyData(const DayVisitor& visitor);
+    bool readDay(DayRecord& record, const QString& dateKey);
+    bool readTimeAxis(DayRecord& record, const QString& dateKey);
+    bool readItem(QString& type, bool& isCompleted, int& minutes);
+
+    void skipWhitespace();
+    bool consume(char c);
+    bool readString(QString* out);
+    bool readNumber(double& value);
+    bool readBool(bool& value);
+    bool skipValue();
+
+    static QDate parseDate(const QString& text);
+
+    void addIssue(qint64 offset, const QString& message);
+    bool fail(const QString& message);
+
+private:
+    const char* m_data = nullptr;
+    qint64 m_size = 0;
+    qint64 m_pos = 0;
+
+    bool m_hasMaxContinuousDays = false;
+    int m_maxContinuousDays = 0;
+    int m_dayCount = 0;
+    QList<Issue> m_issues;
+    QString m_errorString;
+};
+
+#endif // STUDYJSONREADER_H
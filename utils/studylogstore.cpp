@@ -0,0 +1,439 @@
+#include "studylogstore.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+const char kSegmentMagic[4] = {'P', 'T', 'L', 'S'};
+const char kIndexMagic[4] = {'P', 'T', 'L', 'I'};
+const quint16 kFormatVersion = 1;
+const qint64 kSegmentHeaderSize = 8;   // 魔数4字节 + 版本2字节 + 保留2字节
+const qint64 kRecordOverhead = 10;     // 儒略日4字节 + 长度4字节 + 校验2字节
+const qint64 kIndexHeaderSize = 20;    // 魔数4字节 + 版本2字节 + 保留2字节 + 段长度8字节 + 条目数4字节
+const qint64 kIndexEntrySize = 12;     // 儒略日4字节 + 偏移4字节 + 长度4字节
+const qint64 kMaxPayloadSize = 1 << 20;
+const qint64 kCompactThreshold = 64 * 1024; // 失效字节超过此值且多于有效字节时滚动压缩
+
+const char* kSegmentFileName = "study_logs.seg";
+const char* kIndexFileName = "study_logs.idx";
+
+template<typename T>
+void put(QByteArray& out, T value)
+{
+    char buf[sizeof(T)];
+    qToLittleEndian<T>(value, buf);
+    out.append(buf, sizeof(T));
+}
+
+QByteArray segmentHeader()
+{
+    QByteArray header(kSegmentMagic, 4);
+    put<quint16>(header, kFormatVersion);
+    put<quint16>(header, 0);
+    return header;
+}
+
+// 以临时文件替换的方式写出整个文件
+bool replaceFile(const QString& path, const QByteArray& data)
+{
+    const QString tempPath = path + ".tmp";
+    QFile tempFile(tempPath);
+    if (!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "临时文件打开失败：" << tempPath << "，错误：" << tempFile.errorString();
+        return false;
+    }
+    const qint64 written = tempFile.write(data);
+    tempFile.close();
+    if (written != data.size() || tempFile.error() != QFile::NoError) {
+        qCritical() << "临时文件写入失败：" << tempPath << "，错误：" << tempFile.errorString();
+        QFile::remove(tempPath);
+        return false;
+    }
+    QFile::remove(path);
+    if (!QFile::rename(tempPath, path)) {
+        qCritical() << "替换文件失败：" << path;
+        QFile::remove(tempPath);
+        return false;
+    }
+    return true;
+}
+}
+
+StudyLogStore::StudyLogStore()
+{
+}
+
+StudyLogStore::~StudyLogStore()
+{
+    close();
+}
+
+// 打开日志目录
+bool StudyLogStore::open(const QString& directory)
+{
+    close();
+    m_directory = directory;
+    m_segmentPath = directory + "/" + kSegmentFileName;
+    m_indexPath = directory + "/" + kIndexFileName;
+
+    const bool firstUse = !QFile::exists(m_segmentPath) && !QFile::exists(m_indexPath);
+
+    m_segment.setFileName(m_segmentPath);
+    if (!m_segment.open(QIODevice::ReadWrite)) {
+        qCritical() << "日志段文件打开失败：" << m_segmentPath << "，错误：" << m_segment.errorString();
+        return false;
+    }
+
+    // 段文件头缺失或无法识别时重新开始
+    const QByteArray header = m_segment.read(kSegmentHeaderSize);
+    if (header.size() < kSegmentHeaderSize || memcmp(header.constData(), kSegmentMagic, 4) != 0) {
+        if (!header.isEmpty()) {
+            qWarning() << "日志段文件无法识别，已重建：" << m_segmentPath;
+        }
+        m_segment.resize(0);
+        m_segment.seek(0);
+        m_segment.write(segmentHeader());
+        m_segment.flush();
+    }
+
+    qint64 indexedEnd = kSegmentHeaderSize;
+    if (!loadIndex(indexedEnd) || indexedEnd > m_segment.size()) {
+        m_index.clear();
+        indexedEnd = kSegmentHeaderSize;
+    }
+    // 索引落后于段文件（上次追加后未来得及写索引），补扫尾部
+    if (indexedEnd != m_segment.size()) {
+        scanSegment(indexedEnd);
+        saveIndex();
+    }
+
+    if (firstUse) {
+        migrateLegacyLogs();
+    }
+    return true;
+}
+
+// 关闭段文件
+void StudyLogStore::close()
+{
+    if (m_segment.isOpen()) {
+        m_segment.close();
+    }
+    m_index.clear();
+}
+
+// 写入某一天的日志
+bool StudyLogStore::write(const QDate& date, const DayRecord& record, int maxContinuousDays)
+{
+    if (!m_segment.isOpen() || !date.isValid()) {
+        return false;
+    }
+
+    QMap<QDate, DayRecord> day;
+    day.insert(date, record);
+    const QByteArray payload = StudyCodec::encode(day, maxContinuousDays);
+    if (payload.isEmpty()) {
+        qCritical() << "日志序列化失败：" << date;
+        return false;
+    }
+
+    QByteArray bytes;
+    bytes.reserve(payload.size() + kRecordOverhead);
+    put<qint32>(bytes, qint32(date.toJulianDay()));
+    put<quint32>(bytes, quint32(payload.size()));
+    bytes.append(payload);
+    put<quint16>(bytes, qChecksum(QByteArrayView(payload)));
+
+    const qint64 offset = m_segment.size();
+    if (!m_segment.seek(offset) || m_segment.write(bytes) != bytes.size() || !m_segment.flush()) {
+        qCritical() << "日志写入失败：" << m_segmentPath << "，错误：" << m_segment.errorString();
+        m_segment.resize(offset);
+        return false;
+    }
+
+    Entry entry;
+    entry.offset = quint32(offset);
+    entry.length = quint32(payload.size());
+    m_index.insert(date, entry);
+
+    // 被取代的记录积累过多时滚动压缩段文件
+    const qint64 dead = deadBytes();
+    if (dead > kCompactThreshold && dead > m_segment.size() - dead) {
+        return compact();
+    }
+    return saveIndex();
+}
+
+// 读取某一天的日志
+bool StudyLogStore::read(const QDate& date, DayRecord& record, int& maxContinuousDays)
+{
+    const auto it = m_index.constFind(date);
+    if (it == m_index.constEnd()) {
+        return false;
+    }
+
+    QByteArray payload;
+    if (!readPayload(it.value(), payload)) {
+        qWarning() << "日志记录已损坏：" << date;
+        return false;
+    }
+
+    bool found = false;
+    QString errorString;
+    const bool ok = StudyCodec::decode(payload, [&](const QDate& day, const DayRecord& value) {
+        if (day == date) {
+            record = value;
+            found = true;
+        }
+    }, maxContinuousDays, &errorString);
+    if (!ok) {
+        qWarning() << "日志解析失败：" << date << "，错误：" << errorString;
+        return false;
+    }
+    return found;
+}
+
+// 读取全部日志
+int StudyLogStore::readAll(const StudyCodec::DayVisitor& visitor, int& maxContinuousDays)
+{
+    maxContinuousDays = 0;
+    int days = 0;
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        DayRecord record;
+        int logMaxContinuous = 0;
+        if (!read(it.key(), record, logMaxContinuous)) {
+            continue;
+        }
+        visitor(it.key(), record);
+        ++days;
+        maxContinuousDays = qMax(maxContinuousDays, logMaxContinuous);
+    }
+    return days;
+}
+
+// 删除超过保留天数的日志，只修改索引，随后压缩段文件
+int StudyLogStore::prune(const QDate& today, int daysToKeep)
+{
+    if (!m_segment.isOpen()) {
+        return 0;
+    }
+
+    const QDate oldestKept = today.addDays(-daysToKeep);
+    int removed = 0;
+    auto it = m_index.begin();
+    while (it != m_index.end() && it.key() < oldestKept) {
+        qDebug() << "删除旧日志：" << it.key().toString("yyyy-MM-dd");
+        it = m_index.erase(it);
+        ++removed;
+    }
+
+    if (removed > 0) {
+        compact();
+    }
+    return removed;
+}
+
+// 读取索引文件
+bool StudyLogStore::loadIndex(qint64& indexedEnd)
+{
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+
+    if (data.size() < kIndexHeaderSize + 2 || memcmp(data.constData(), kIndexMagic, 4) != 0) {
+        qWarning() << "日志索引无法识别，将从段文件重建：" << m_indexPath;
+        return false;
+    }
+    const quint16 storedCrc = qFromLittleEndian<quint16>(data.constData() + data.size() - 2);
+    if (qChecksum(QByteArrayView(data).first(data.size() - 2)) != storedCrc) {
+        qWarning() << "日志索引校验失败，将从段文件重建：" << m_indexPath;
+        return false;
+    }
+
+    const char* raw = data.constData();
+    const qint64 segmentEnd = qFromLittleEndian<qint64>(raw + 8);
+    const quint32 count = qFromLittleEndian<quint32>(raw + 16);
+    if (kIndexHeaderSize + qint64(count) * kIndexEntrySize + 2 != data.size()) {
+        qWarning() << "日志索引长度不符，将从段文件重建：" << m_indexPath;
+        return false;
+    }
+
+    m_index.clear();
+    const char* entry = raw + kIndexHeaderSize;
+    for (quint32 i = 0; i < count; ++i, entry += kIndexEntrySize) {
+        const QDate date = QDate::fromJulianDay(qFromLittleEndian<qint32>(entry));
+        Entry value;
+        value.offset = qFromLittleEndian<quint32>(entry + 4);
+        value.length = qFromLittleEndian<quint32>(entry + 8);
+        if (!date.isValid() || value.offset < kSegmentHeaderSize
+            || value.offset + kRecordOverhead + value.length > segmentEnd) {
+            qWarning() << "日志索引条目无效，将从段文件重建：" << m_indexPath;
+            m_index.clear();
+            return false;
+        }
+        m_index.insert(date, value);
+    }
+    indexedEnd = segmentEnd;
+    return true;
+}
+
+// 写出索引文件
+bool StudyLogStore::saveIndex()
+{
+    QByteArray data;
+    data.reserve(kIndexHeaderSize + m_index.size() * kIndexEntrySize + 2);
+    data.append(kIndexMagic, 4);
+    put<quint16>(data, kFormatVersion);
+    put<quint16>(data, 0);
+    put<qint64>(data, m_segment.size());
+    put<quint32>(data, quint32(m_index.size()));
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        put<qint32>(data, qint32(it.key().toJulianDay()));
+        put<quint32>(data, it.value().offset);
+        put<quint32>(data, it.value().length);
+    }
+    put<quint16>(data, qChecksum(QByteArrayView(data)));
+    return replaceFile(m_indexPath, data);
+}
+
+// 从指定位置扫描段文件补全索引，截断残缺的尾部
+void StudyLogStore::scanSegment(qint64 from)
+{
+    const qint64 size = m_segment.size();
+    qint64 pos = from;
+    while (pos + kRecordOverhead <= size) {
+        m_segment.seek(pos);
+        const QByteArray head = m_segment.read(8);
+        const QDate date = QDate::fromJulianDay(qFromLittleEndian<qint32>(head.constData()));
+        const quint32 length = qFromLittleEndian<quint32>(head.constData() + 4);
+        if (!date.isValid() || length > kMaxPayloadSize || pos + kRecordOverhead + length > size) {
+            break;
+        }
+
+        Entry entry;
+        entry.offset = quint32(pos);
+        entry.length = length;
+        QByteArray payload;
+        if (!readPayload(entry, payload)) {
+            break;
+        }
+        m_index.insert(date, entry);
+        pos += kRecordOverhead + length;
+    }
+
+    if (pos != size) {
+        qWarning() << "日志段文件在偏移" << pos << "处残缺，已截断" << size - pos << "字节";
+        m_segment.resize(pos);
+    }
+}
+
+// 读取一条记录的负载并校验
+bool StudyLogStore::readPayload(const Entry& entry, QByteArray& payload)
+{
+    if (!m_segment.seek(entry.offset + 8)) {
+        return false;
+    }
+    const QByteArray bytes = m_segment.read(entry.length + 2);
+    if (bytes.size() != qint64(entry.length) + 2) {
+        return false;
+    }
+    payload = bytes.left(entry.length);
+    return qChecksum(QByteArrayView(payload)) == qFromLittleEndian<quint16>(bytes.constData() + entry.length);
+}
+
+// 只保留索引中的记录，重写段文件
+bool StudyLogStore::compact()
+{
+    QByteArray data = segmentHeader();
+    QMap<QDate, Entry> newIndex;
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        if (!m_segment.seek(it.value().offset)) {
+            continue;
+        }
+        const QByteArray record = m_segment.read(kRecordOverhead + it.value().length);
+        if (record.size() != kRecordOverhead + it.value().length) {
+            continue;
+        }
+        Entry entry = it.value();
+        entry.offset = quint32(data.size());
+        data.append(record);
+        newIndex.insert(it.key(), entry);
+    }
+
+    const qint64 before = m_segment.size();
+    m_segment.close();
+    const bool ok = replaceFile(m_segmentPath, data);
+    m_segment.setFileName(m_segmentPath);
+    if (!m_segment.open(QIODevice::ReadWrite)) {
+        qCritical() << "日志段文件重新打开失败：" << m_segmentPath << "，错误：" << m_segment.errorString();
+        return false;
+    }
+    if (!ok) {
+        // 原段文件若已丢失，只能从空段文件重新开始
+        if (m_segment.size() < kSegmentHeaderSize) {
+            m_index.clear();
+            m_segment.resize(0);
+            m_segment.write(segmentHeader());
+            m_segment.flush();
+        }
+        return saveIndex();
+    }
+
+    m_index = newIndex;
+    qDebug() << "日志段文件已压缩：" << before << "->" << data.size() << "字节";
+    return saveIndex();
+}
+
+// 段文件中已失效的字节数
+qint64 StudyLogStore::deadBytes() const
+{
+    qint64 live = kSegmentHeaderSize;
+    for (const Entry& entry : m_index) {
+        live += kRecordOverhead + entry.length;
+    }
+    return m_segment.size() - live;
+}
+
+// 把旧版按天存放的JSON日志文件并入段文件，只在首次使用时执行一次
+void StudyLogStore::migrateLegacyLogs()
+{
+    QDir logDir(m_directory);
+    const QFileInfoList logFiles = logDir.entryInfoList(QStringList() << "*.json", QDir::Files);
+
+    int migrated = 0;
+    for (const QFileInfo& fileInfo : logFiles) {
+        const QDate logDate = QDate::fromString(fileInfo.completeBaseName(), "yyyy-MM-dd");
+        if (!logDate.isValid()) {
+            continue;
+        }
+
+        QMap<QDate, DayRecord> days;
+        int maxContinuous = 0;
+        QString errorString;
+        const bool ok = StudyCodec::decodeFile(fileInfo.absoluteFilePath(), [&days](const QDate& date, const DayRecord& record) {
+            days.insert(date, record);
+        }, maxContinuous, &errorString);
+        if (!ok) {
+            qWarning() << "旧日志解析失败，保留原文件：" << fileInfo.absoluteFilePath() << "，错误：" << errorString;
+            continue;
+        }
+
+        bool written = true;
+        for (auto it = days.constBegin(); it != days.constEnd(); ++it) {
+            written = write(it.key(), it.value(), maxContinuous) && written;
+        }
+        if (written) {
+            QFile::remove(fileInfo.absoluteFilePath());
+            ++migrated;
+        }
+    }
+
+    if (migrated > 0) {
+        qDebug() << "已将" << migrated << "个旧日志文件并入日志段文件";
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef STUDYLOGSTORE_H
+#define STUDYLOGSTORE_H
+
+#include <QFile>
+#include <QDate>
+#include <QMap>
+#include <QList>
+#include "utils/dayrecord.h"
+#include "utils/studycodec.h"
+
+/**
+ * @brief The StudyLogStore class
+ * 每日日志存储。所有日志追加写入日志目录下的单个段文件，
+ * 另有一个小索引文件记录每个日期最新一条记录的偏移与长度。
+ * 保留期清理与恢复都只操作索引，过期或被覆盖的记录在段文件滚动压缩时丢弃。
+ * 索引缺失或落后于段文件时，从段文件扫描重建。
+ * 段文件记录格式：[儒略日i32][负载长度u32][负载（单日二进制存档）][校验u16]
+ */
+class StudyLogStore
+{
+public:
+    // 默认日志保留天数
+    static const int kDaysToKeep = 30;
+
+    StudyLogStore();
+    ~StudyLogStore();
+
+    // 打开日志目录，首次使用时迁移旧版按天存放的日志文件
+    // 参数1：日志目录
+    // 返回：是否成功
+    bool open(const QString& directory);
+
+    // 关闭段文件
+    void close();
+
+    // 写入某一天的日志，同一日期的旧记录被新记录取代
+    // 参数1：日期
+    // 参数2：单日记录
+    // 参数3：最大连续天数
+    // 返回：是否成功
+    bool write(const QDate& date, const DayRecord& record, int maxContinuousDays);
+
+    // 读取某一天的日志
+    // 参数1：日期
+    // 参数2：输出，单日记录
+    // 参数3：输出，最大连续天数
+    // 返回：是否存在且完好
+    bool read(const QDate& date, DayRecord& record, int& maxContinuousDays);
+
+    // 读取全部日志
+    // 参数1：访问者
+    // 参数2：输出，各日志中最大连续天数的最大值
+    // 返回：成功读取的天数
+    int readAll(const StudyCodec::DayVisitor& visitor, int& maxContinuousDays);
+
+    // 删除超过保留天数的日志
+    // 参数1：今天的日期
+    // 参数2：保留天数
+    // 返回：删除的天数
+    int prune(const QDate& today, int daysToKeep = kDaysToKeep);
+
+    // 获取已记录的日期，按日期升序
+    QList<QDate> dates() const {return m_index.keys();}
+
+    // 获取已记录的天数
+    int count() const {return m_index.size();}
+
+private:
+    struct Entry
+    {
+        quint32 offset = 0; // 记录在段文件中的起始位置
+        quint32 length = 0; // 负载长度
+    };
+
+    // 读取索引文件
+    // 参数1：输出，索引覆盖到的段文件长度
+    bool loadIndex(qint64& indexedEnd);
+
+    // 写出索引文件
+    bool saveIndex();
+
+    // 从指定位置扫描段文件补全索引，截断残缺的尾部
+    void scanSegment(qint64 from);
+
+    // 读取一条记录的负载并校验
+    bool readPayload(const Entry& entry, QByteArray& payload);
+
+    // 只保留索引中的记录，重写段文件
+    bool compact();
+
+    // 段文件中已失效的字节数
+    qint64 deadBytes() const;
+
+    // 把旧版按天存放的JSON日志文件并入段文件
+    void migrateLegacyLogs();
+
+private:
+    QString m_directory;
+    QString m_segmentPath;
+    QString m_indexPath;
+    QFile m_segment;
+    QMap<QDate, Entry> m_index;
+};
+
+#endif // STUDYLOGSTORE_H
@@ -0,0 +1,129 @@
+#include "studyrollups.h"
+
+// 清空全部汇总
+void StudyRollups::clear()
+{
+    for (QMap<int, Rollup>& rollups : m_rollups) {
+        rollups.clear();
+    }
+    m_built = false;
+}
+
+// 计入或扣除某一天，三个粒度各改动一个汇总项，汇总为空时删除
+void StudyRollups::addDay(const QDate& date, const DayRecord& record, int sign)
+{
+    if (!date.isValid() || record.totalProjects == 0) {
+        return;
+    }
+
+    for (int period = 0; period < PeriodCount; ++period) {
+        const Period p = Period(period);
+        auto it = m_rollups[p].find(periodKey(p, date));
+        if (it == m_rollups[p].end()) {
+            if (sign < 0) {
+                continue;
+            }
+            it = m_rollups[p].insert(periodKey(p, date), Rollup());
+            it->start = periodStart(p, date);
+        }
+
+        Rollup& rollup = it.value();
+        rollup.recordedDays += sign;
+        rollup.studyDays += record.studyMinutes > 0 ? sign : 0;
+        rollup.targetDays += record.reachesTarget(m_targetHours) ? sign : 0;
+        rollup.studyMinutes += sign * record.studyMinutes;
+        rollup.completedProjects += sign * record.completedProjects;
+        rollup.totalProjects += sign * record.totalProjects;
+        addCategories(rollup, record, sign);
+
+        if (rollup.recordedDays <= 0) {
+            m_rollups[p].erase(it);
+        }
+    }
+}
+
+// 计入或扣除单日各类型的时段数，计数范围内的类型直接读取单日计数，只有超出范围的类型才遍历时段
+void StudyRollups::addCategories(Rollup& rollup, const DayRecord& record, int sign)
+{
+    for (int category = 0; category < DayRecord::kCountedCategories; ++category) {
+        const int slots = record.categorySlotCounts[category];
+        if (slots == 0) {
+            continue;
+        }
+        if (category >= rollup.categorySlots.size()) {
+            rollup.categorySlots.resize(category + 1);
+        }
+        rollup.categorySlots[category] += sign * slots;
+    }
+    if (record.uncountedSlots == 0) {
+        return;
+    }
+    for (int slot = 0; slot < DayRecord::kSlotCount; ++slot) {
+        const quint8 category = record.categoryAt(slot);
+        if (category == DayRecord::kEmptySlot || category < DayRecord::kCountedCategories) {
+            continue;
+        }
+        if (category >= rollup.categorySlots.size()) {
+            rollup.categorySlots.resize(category + 1);
+        }
+        rollup.categorySlots[category] += sign;
+    }
+}
+
+// 按周期列出某一类型的分钟数
+QMap<QDate, int> StudyRollups::categoryMinutes(Period period, quint8 category, const QDate& from, const QDate& to) const
+{
+    QMap<QDate, int> minutes;
+    const QMap<int, Rollup>& rollups = m_rollups[period];
+    auto it = from.isValid() ? rollups.lowerBound(periodKey(period, from)) : rollups.constBegin();
+    const auto end = to.isValid() ? rollups.upperBound(periodKey(period, to)) : rollups.constEnd();
+    for (; it != end; ++it) {
+        minutes.insert(it->start, it->categoryMinutes(category));
+    }
+    return minutes;
+}
+
+// 获取日期所在周期的键
+int StudyRollups::periodKey(Period period, const QDate& date)
+{
+    switch (period) {
+    case Week: {
+        int isoYear = 0;
+        const int week = date.weekNumber(&isoYear);
+        return isoYear * 100 + week;
+    }
+    case Month:
+        return date.year() * 100 + date.month();
+    default:
+        return date.year();
+    }
+}
+
+// 获取日期所在周期的第一天，ISO周从周一开始
+QDate StudyRollups::periodStart(Period period, const QDate& date)
+{
+    switch (period) {
+    case Week:
+        return date.addDays(1 - date.dayOfWeek());
+    case Month:
+        return QDate(date.year(), date.month(), 1);
+    default:
+        return QDate(date.year(), 1, 1);
+    }
+}
+
+// 获取周期的显示名称
+QString StudyRollups::periodLabel(Period period, const QDate& start)
+{
+    switch (period) {
+    case Week: {
+        int isoYear = 0;
+        const int week = start.weekNumber(&isoYear);
+        return QString("%1年第%2周（%3起）").arg(isoYear).arg(week).arg(start.toString("MM-dd"));
+    }
+    case Month:
+        return QString("%1年%2月").arg(start.year()).arg(start.month());
+    default:
+        return QString("%1年").arg(start.year());
+    }
+}
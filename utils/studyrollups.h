@@ -0,0 +1,108 @@
+#ifndef STUDYROLLUPS_H
+#define STUDYROLLUPS_H
+
+#include <QDate>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include "utils/dayrecord.h"
+
+/**
+ * @brief The StudyRollups class
+ * 按ISO周、月、年预先汇总的学习统计：学习时长、完成数与总数、各类型时段数、达标天数。
+ * 各类型时段数由单日记录中的逐类型计数累加，按类型编号索引，类型查询直接读取汇总。
+ * 单日修改时先扣除旧记录再计入新记录，三个粒度各只改动一个汇总项；
+ * 仪表盘直接读取汇总，切换粒度不需要扫描历史。
+ * 达标天数依赖学习目标，目标变化后需要重建。
+ */
+class StudyRollups
+{
+public:
+    // 汇总粒度
+    enum Period {
+        Week,  // ISO周
+        Month, // 自然月
+        Year,  // 自然年
+        PeriodCount
+    };
+
+    // 单个周期的汇总
+    struct Rollup
+    {
+        QDate start;               // 周期的第一天
+        int recordedDays = 0;      // 有安排的天数
+        int studyDays = 0;         // 学习时长大于零的天数
+        int targetDays = 0;        // 达到学习目标的天数
+        int studyMinutes = 0;      // 学习分钟数
+        int completedProjects = 0; // 完成项目数
+        int totalProjects = 0;     // 总项目数
+        QVector<int> categorySlots; // 各类型的15分钟时段数，下标为类型编号
+
+        // 达标率，以有安排的天数为分母
+        double targetHitRate() const {return recordedDays > 0 ? double(targetDays) / recordedDays : 0.0;}
+
+        // 指定类型的分钟数
+        int categoryMinutes(quint8 category) const {return category < categorySlots.size() ? categorySlots[category] * DayRecord::kSlotMinutes : 0;}
+    };
+
+public:
+    // 清空全部汇总，之后需要重建
+    void clear();
+
+    // 是否已建立
+    bool isBuilt() const {return m_built;}
+
+    // 标记为已建立
+    void setBuilt(){m_built = true;}
+
+    // 设置计算达标天数使用的学习目标
+    // 参数1：学习目标小时数
+    void setTargetHours(int targetHours){m_targetHours = targetHours;}
+
+    // 计入或扣除某一天
+    // 参数1：日期
+    // 参数2：单日记录
+    // 参数3：1为计入，-1为扣除
+    void addDay(const QDate& date, const DayRecord& record, int sign);
+
+    // 某一天由旧记录变为新记录
+    void update(const QDate& date, const DayRecord& before, const DayRecord& after)
+    {
+        addDay(date, before, -1);
+        addDay(date, after, 1);
+    }
+
+    // 获取某一粒度的全部汇总，按周期先后排序
+    const QMap<int, Rollup>& rollups(Period period) const {return m_rollups[period];}
+
+    // 按周期列出某一类型的分钟数，例如近一年每周的游戏时长，只读取汇总，不遍历历史
+    // 参数1：粒度
+    // 参数2：类型编号
+    // 参数3：起始日期（含），无效时不限
+    // 参数4：结束日期（含），无效时不限
+    // 返回：按周期第一天索引的分钟数，没有记录的周期不出现
+    QMap<QDate, int> categoryMinutes(Period period, quint8 category, const QDate& from = QDate(), const QDate& to = QDate()) const;
+
+    // 获取日期所在周期的键，ISO周为“ISO年*100+周数”，月为“年*100+月”，年为年份
+    static int periodKey(Period period, const QDate& date);
+
+    // 获取日期所在周期的第一天
+    static QDate periodStart(Period period, const QDate& date);
+
+    // 获取周期的显示名称
+    static QString periodLabel(Period period, const QDate& start);
+
+private:
+    // 计入或扣除单日各类型的时段数
+    // 参数1：汇总
+    // 参数2：单日记录
+    // 参数3：1为计入，-1为扣除
+    static void addCategories(Rollup& rollup, const DayRecord& record, int sign);
+
+private:
+    QMap<int, Rollup> m_rollups[PeriodCount];
+    int m_targetHours = 4;
+    bool m_built = false;
+};
+
+#endif // STUDYROLLUPS_H
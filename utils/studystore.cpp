@@ -0,0 +1,432 @@
+#include "studystore.h"
+#include <QDebug>
+
+namespace {
+int monthKey(const QDate& date)
+{
+    return date.year() * 12 + date.month() - 1;
+}
+}
+
+StudyStore::Cursor::Cursor(const StudyStore& store, const QDate& from, const QDate& to)
+    : m_store(store)
+{
+    const StudyCodec::View& view = store.m_view;
+    const QMap<QDate, DayRecord>& cache = store.m_cache;
+    m_index = from.isValid() ? view.lowerBound(from) : 0;
+    m_count = to.isValid() ? view.lowerBound(to.addDays(1)) : view.dayCount();
+    m_cacheIt = from.isValid() ? cache.lowerBound(from) : cache.constBegin();
+    m_cacheEnd = to.isValid() ? cache.upperBound(to) : cache.constEnd();
+    settle();
+}
+
+// 当前日期的统计字段，存档中的日期直接读取索引
+const DayRecord& StudyStore::Cursor::summary()
+{
+    if (m_fromCache) {
+        return m_cacheIt.value();
+    }
+    m_store.m_view.summaryAt(m_index, m_buffer);
+    return m_buffer;
+}
+
+// 当前日期的完整记录，存档中的日期解码到游标的缓冲中
+const DayRecord& StudyStore::Cursor::record()
+{
+    if (m_fromCache) {
+        return m_cacheIt.value();
+    }
+    if (!m_store.m_view.recordAt(m_index, m_buffer)) {
+        qWarning() << "存档中" << m_date << "的数据已损坏，已跳过";
+        m_buffer = DayRecord();
+    }
+    return m_buffer;
+}
+
+// 移到下一个有数据的日期
+void StudyStore::Cursor::next()
+{
+    if (m_atEnd) {
+        return;
+    }
+    if (m_fromCache) {
+        if (m_alsoInFile) {
+            ++m_index;
+        }
+        ++m_cacheIt;
+    } else {
+        ++m_index;
+    }
+    settle();
+}
+
+// 在存档与缓存中选出下一个日期
+void StudyStore::Cursor::settle()
+{
+    const bool fileLeft = m_index < m_count;
+    const bool cacheLeft = m_cacheIt != m_cacheEnd;
+    if (!fileLeft && !cacheLeft) {
+        m_atEnd = true;
+        return;
+    }
+
+    const QDate fileDate = fileLeft ? m_store.m_view.dateAt(m_index) : QDate();
+    m_fromCache = cacheLeft && (!fileLeft || m_cacheIt.key() <= fileDate);
+    m_alsoInFile = m_fromCache && fileLeft && m_cacheIt.key() == fileDate;
+    m_date = m_fromCache ? m_cacheIt.key() : fileDate;
+}
+
+StudyStore::StudyStore() {}
+
+StudyStore::~StudyStore()
+{
+    unmap();
+}
+
+// 以内存映射方式打开二进制存档并校验，成功后丢弃当前缓存
+bool StudyStore::openMapped(const QString& path, QString* errorString)
+{
+    return mapArchive(path, m_editSerial, errorString);
+}
+
+// 映射并校验存档，成功后替换当前映射，只保留修改序号大于给定值的脏数据
+bool StudyStore::mapArchive(const QString& path, quint64 keepAfterSerial, QString* errorString)
+{
+    QFile* file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = file->errorString();
+        delete file;
+        return false;
+    }
+
+    const qint64 size = file->size();
+    uchar* mapped = size > 0 ? file->map(0, size) : nullptr;
+    if (!mapped) {
+        if (errorString) *errorString = size > 0 ? file->errorString() : QString("存档为空");
+        delete file;
+        return false;
+    }
+
+    StudyCodec::View view;
+    if (!view.attach(mapped, size, errorString)) {
+        file->unmap(mapped);
+        delete file;
+        return false;
+    }
+    if (!view.verifyChecksum()) {
+        if (errorString) *errorString = "存档校验失败，数据可能已损坏";
+        file->unmap(mapped);
+        delete file;
+        return false;
+    }
+
+    // 存档写入后又发生的修改不在新存档中，需要继续保留
+    QMap<QDate, DayRecord> kept;
+    QHash<QDate, quint64> keptDirty;
+    keptChanges(keepAfterSerial, kept, keptDirty);
+
+    unmap();
+    m_file = file;
+    m_mapped = mapped;
+    m_archivePath = path;
+    m_view = view;
+    m_cache = kept;
+    m_dirty = keptDirty;
+    m_extraDays = 0;
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        if (m_view.indexOf(it.key()) < 0) {
+            ++m_extraDays;
+        }
+    }
+    m_monthLru.clear();
+    resetColumns();
+
+    qDebug() << "已映射学习存档：" << path << "，共" << m_view.dayCount() << "天";
+    return true;
+}
+
+// 整体解码存档放入缓存，再叠加修改序号大于给定值的脏数据
+bool StudyStore::loadArchive(const QString& path, quint64 keepAfterSerial, QString* errorString)
+{
+    QMap<QDate, DayRecord> days;
+    int maxContinuousDays = 0;
+    const bool ok = StudyCodec::decodeFile(path, [&days](const QDate& date, const DayRecord& record) {
+        days.insert(date, record);
+    }, maxContinuousDays, errorString);
+    if (!ok) {
+        return false;
+    }
+
+    QMap<QDate, DayRecord> kept;
+    QHash<QDate, quint64> keptDirty;
+    keptChanges(keepAfterSerial, kept, keptDirty);
+    for (auto it = kept.constBegin(); it != kept.constEnd(); ++it) {
+        days.insert(it.key(), it.value());
+    }
+
+    // 内容与原存档相同，修改过的月份记录保持不变
+    const QSet<QDate> changedMonths = m_changedMonths;
+    const bool monthsReplaced = m_monthsReplaced;
+    replaceAll(days);
+    m_dirty = keptDirty;
+    m_changedMonths = changedMonths;
+    m_monthsReplaced = monthsReplaced;
+    return true;
+}
+
+// 取出修改序号大于给定值的脏数据
+void StudyStore::keptChanges(quint64 keepAfterSerial, QMap<QDate, DayRecord>& kept, QHash<QDate, quint64>& keptDirty) const
+{
+    for (auto dirtyIt = m_dirty.constBegin(); dirtyIt != m_dirty.constEnd(); ++dirtyIt) {
+        auto it = m_cache.constFind(dirtyIt.key());
+        if (dirtyIt.value() > keepAfterSerial && it != m_cache.constEnd()) {
+            kept.insert(it.key(), it.value());
+            keptDirty.insert(dirtyIt.key(), dirtyIt.value());
+        }
+    }
+}
+
+// 用写好的新存档替换磁盘上的存档并重新映射
+bool StudyStore::replaceArchive(const QString& path, const std::function<bool()>& replace, quint64 savedSerial)
+{
+    // 释放映射后缓存中的修改仍在，替换失败时全部保留
+    unmap();
+    const bool replaced = replace();
+    const quint64 keepAfter = replaced ? savedSerial : 0;
+
+    QString error;
+    if (mapArchive(path, keepAfter, &error)) {
+        return replaced;
+    }
+    qWarning() << "存档无法重新映射，改为整体读入内存：" << error;
+    if (loadArchive(path, keepAfter, &error)) {
+        return replaced;
+    }
+
+    // 存档无法读取时保留路径，下次保存仍需与存档合并，不会用缓存中的部分数据覆盖存档
+    qCritical() << "存档无法读取，未修改的日期暂时不可用：" << error;
+    m_archivePath = path;
+    return replaced;
+}
+
+// 释放存档映射
+void StudyStore::unmap()
+{
+    m_view.detach();
+    if (m_file) {
+        if (m_mapped) {
+            m_file->unmap(m_mapped);
+        }
+        m_file->close();
+        delete m_file;
+    }
+    m_file = nullptr;
+    m_mapped = nullptr;
+}
+
+// 用给定数据替换全部内容，并释放存档映射
+void StudyStore::replaceAll(const QMap<QDate, DayRecord>& days)
+{
+    unmap();
+    m_archivePath.clear();
+    m_cache = days;
+    // 全部标记为新的修改，替换前提交的快照重新映射存档时不会丢弃这些数据
+    m_dirty.clear();
+    ++m_editSerial;
+    for (auto it = days.constBegin(); it != days.constEnd(); ++it) {
+        m_dirty.insert(it.key(), m_editSerial);
+    }
+    m_extraDays = days.size();
+    m_changedMonths.clear();
+    m_monthsReplaced = true;
+    m_monthLru.clear();
+    resetColumns();
+}
+
+// 清空修改过的月份记录
+void StudyStore::clearChangedMonths()
+{
+    m_changedMonths.clear();
+    m_monthsReplaced = false;
+}
+
+// 解码全部日期，返回完整数据
+QMap<QDate, DayRecord> StudyStore::toMap() const
+{
+    if (!isMapped()) {
+        return m_cache;
+    }
+
+    QMap<QDate, DayRecord> days;
+    for (int i = 0; i < m_view.dayCount(); ++i) {
+        const QDate date = m_view.dateAt(i);
+        if (m_cache.contains(date)) {
+            continue;
+        }
+        DayRecord record;
+        if (m_view.recordAt(i, record)) {
+            days.insert(date, record);
+        } else {
+            qWarning() << "存档中" << date << "的数据已损坏，已跳过";
+        }
+    }
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        days.insert(it.key(), it.value());
+    }
+    return days;
+}
+
+// 取出整体保存所需的数据：数据来自存档时只取出修改过的日期，由写入方与存档合并
+bool StudyStore::prepareSave(QMap<QDate, DayRecord>& days) const
+{
+    if (m_archivePath.isEmpty()) {
+        days = m_cache;
+        return false;
+    }
+
+    days.clear();
+    for (auto it = m_dirty.constBegin(); it != m_dirty.constEnd(); ++it) {
+        auto cacheIt = m_cache.constFind(it.key());
+        if (cacheIt != m_cache.constEnd()) {
+            days.insert(cacheIt.key(), cacheIt.value());
+        }
+    }
+    return true;
+}
+
+// 检查是否包含指定日期
+bool StudyStore::contains(const QDate& date) const
+{
+    return m_cache.contains(date) || m_view.indexOf(date) >= 0;
+}
+
+// 获取指定日期的单日记录（按需解码）
+DayRecord StudyStore::record(const QDate& date) const
+{
+    const DayRecord* record = load(date);
+    return record ? *record : DayRecord();
+}
+
+// 获取最早有数据的日期，存档索引与缓存都按日期有序，各取首个比较
+QDate StudyStore::firstDate() const
+{
+    QDate first = m_view.dayCount() > 0 ? m_view.dateAt(0) : QDate();
+    if (!m_cache.isEmpty() && (!first.isValid() || m_cache.firstKey() < first)) {
+        first = m_cache.firstKey();
+    }
+    return first;
+}
+
+// 获取最晚有数据的日期
+QDate StudyStore::lastDate() const
+{
+    QDate last = m_view.dayCount() > 0 ? m_view.dateAt(m_view.dayCount() - 1) : QDate();
+    if (!m_cache.isEmpty() && (!last.isValid() || m_cache.lastKey() > last)) {
+        last = m_cache.lastKey();
+    }
+    return last;
+}
+
+// 获取指定日期单日记录的可写引用，不存在时创建，并标记为已修改
+DayRecord& StudyStore::operator[](const QDate& date)
+{
+    DayRecord* data = load(date);
+    if (!data) {
+        data = &m_cache[date];
+        ++m_extraDays;
+    }
+    m_dirty.insert(date, ++m_editSerial);
+    m_changedMonths.insert(QDate(date.year(), date.month(), 1));
+    // 调用方可能通过引用修改统计字段，所在年份的列式统计失效
+    m_staleYears.insert(date.year());
+    return *data;
+}
+
+// 插入或覆盖指定日期的单日记录
+void StudyStore::insert(const QDate& date, const DayRecord& record)
+{
+    (*this)[date] = record;
+}
+
+// 解码指定日期进缓存
+DayRecord* StudyStore::load(const QDate& date) const
+{
+    auto it = m_cache.find(date);
+    if (it != m_cache.end()) {
+        return &it.value();
+    }
+
+    const int index = m_view.indexOf(date);
+    if (index < 0) {
+        return nullptr;
+    }
+
+    DayRecord record;
+    if (!m_view.recordAt(index, record)) {
+        // 损坏的日期按空记录处理，统计与时段保持一致，编辑后整天重写
+        qWarning() << "存档中" << date << "的数据已损坏，按空记录处理";
+        record = DayRecord();
+    }
+    touchMonth(date);
+    return &m_cache.insert(date, record).value();
+}
+
+// 记录月份访问，超出上限时淘汰最久未访问月份中未修改的数据
+void StudyStore::touchMonth(const QDate& date) const
+{
+    const int key = monthKey(date);
+    m_monthLru.removeOne(key);
+    m_monthLru.prepend(key);
+
+    while (m_monthLru.size() > m_maxCachedMonths) {
+        const int evictKey = m_monthLru.takeLast();
+        const QDate first(evictKey / 12, evictKey % 12 + 1, 1);
+        const QDate last = first.addMonths(1);
+        auto it = m_cache.lowerBound(first);
+        while (it != m_cache.end() && it.key() < last) {
+            // 只淘汰未修改且能从存档重新解码的日期
+            if (!m_dirty.contains(it.key()) && m_view.indexOf(it.key()) >= 0) {
+                it = m_cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+// 统计日期区间内的天数、学习时长、完成数与总数
+StudyColumns::Totals StudyStore::totals(const QDate& from, const QDate& to) const
+{
+    ensureColumns();
+    return m_columns.totals(from, to);
+}
+
+// 建立列式统计，或重建已失效的年份
+void StudyStore::ensureColumns() const
+{
+    if (!m_columnsBuilt) {
+        m_columns.clear();
+        forEachSummary([this](const QDate& date, const DayRecord& record) {
+            m_columns.setDay(date, record);
+        });
+        m_columnsBuilt = true;
+        m_staleYears.clear();
+        return;
+    }
+
+    for (int year : std::as_const(m_staleYears)) {
+        m_columns.clearYear(year);
+        forEachSummary(QDate(year, 1, 1), QDate(year, 12, 31), [this](const QDate& date, const DayRecord& record) {
+            m_columns.setDay(date, record);
+        });
+    }
+    m_staleYears.clear();
+}
+
+// 丢弃列式统计，下次统计时重建
+void StudyStore::resetColumns()
+{
+    m_columns.clear();
+    m_columnsBuilt = false;
+    m_staleYears.clear();
+}
@@ -0,0 +1,254 @@
+#ifndef STUDYSTORE_H
+#define STUDYSTORE_H
+
+#include <QFile>
+#include <QDate>
+#include <QMap>
+#include <QSet>
+#include <QHash>
+#include <QList>
+#include <functional>
+#include "utils/dayrecord.h"
+#include "utils/studycodec.h"
+#include "utils/studycolumns.h"
+
+/**
+ * @brief The StudyStore class
+ * 学习历史的存储，按日期访问。
+ * 存档以内存映射方式打开，只读取文件头与日期索引，启动耗时与历史长度无关；
+ * 某一天只有在被record()/operator[]访问时才解码进缓存，缓存中保存定长的DayRecord。
+ * 未修改的缓存按月份做LRU淘汰，常驻内存只跟随用户实际查看的月份；
+ * 修改过（脏）的日期在下次保存前始终保留在缓存中。
+ * 保存时只取出脏数据（prepareSave()），由后台线程自行映射存档合并编码，界面线程不读取未修改的日期；
+ * 保存期间发生的修改带有更新的修改序号，替换存档重新映射时可以保留下来。
+ * 统计字段另存一份按年分块的列式副本，首次统计时建立，修改只让所在年份失效。
+ */
+class StudyStore
+{
+public:
+    /**
+     * @brief The Cursor class
+     * 日期区间上的有序游标，按日期顺序合并存档索引与缓存，只经过有数据的日期。
+     * 定位只做两次二分查找，之后每步O(1)，区间查询总耗时为O(log n + k)；
+     * 存档中的记录解码到游标自带的缓冲中，不分配内存，也不放入缓存。
+     * 游标使用期间不得修改存储。
+     */
+    class Cursor
+    {
+    public:
+        // 参数1：存储
+        // 参数2：起始日期（含），无效时不限
+        // 参数3：结束日期（含），无效时不限
+        Cursor(const StudyStore& store, const QDate& from, const QDate& to);
+
+        // 是否已越过区间末尾
+        bool atEnd() const {return m_atEnd;}
+
+        // 当前日期
+        const QDate& date() const {return m_date;}
+
+        // 当前日期的统计字段（学习时长、完成数、总数），不解码时段
+        const DayRecord& summary();
+
+        // 当前日期的完整记录，存档中的数据损坏时返回空记录
+        const DayRecord& record();
+
+        // 移到下一个有数据的日期
+        void next();
+
+    private:
+        // 在存档与缓存中选出下一个日期，同一天两处都有时以缓存为准
+        void settle();
+
+    private:
+        const StudyStore& m_store;
+        int m_index = 0;
+        int m_count = 0;
+        QMap<QDate, DayRecord>::const_iterator m_cacheIt;
+        QMap<QDate, DayRecord>::const_iterator m_cacheEnd;
+        bool m_atEnd = false;
+        bool m_fromCache = false;
+        bool m_alsoInFile = false;
+        QDate m_date;
+        DayRecord m_buffer;
+    };
+
+public:
+    StudyStore();
+    ~StudyStore();
+
+    // 以内存映射方式打开二进制存档并校验，成功后丢弃当前缓存
+    // 参数1：存档路径
+    // 参数2：输出，错误信息
+    // 返回：是否成功，失败时保持原有数据不变
+    bool openMapped(const QString& path, QString* errorString = nullptr);
+
+    // 是否已映射存档
+    bool isMapped() const {return m_view.isValid();}
+
+    // 获取映射存档中记录的最大连续天数
+    int mappedMaxContinuousDays() const {return m_view.maxContinuousDays();}
+
+    // 用给定数据替换全部内容，并释放存档映射
+    // 参数1：按日期索引的单日记录
+    void replaceAll(const QMap<QDate, DayRecord>& days);
+
+    // 解码全部日期，返回完整数据
+    QMap<QDate, DayRecord> toMap() const;
+
+    // 取出整体保存所需的数据，不读取也不解码未修改的日期，映射保持不变
+    // 参数1：输出，需要写入的日期；数据来自存档时只有修改过的日期，否则为全部数据
+    // 返回：是否需要与磁盘上的存档合并
+    bool prepareSave(QMap<QDate, DayRecord>& days) const;
+
+    // 当前的修改序号，在prepareSave()之前取得，写入的存档包含此序号及之前的全部修改
+    quint64 editSerial() const {return m_editSerial;}
+
+    // 用写好的新存档替换磁盘上的存档并重新映射
+    // 被映射的文件无法被替换，先释放映射，调用replace替换文件后立即重新映射；
+    // 重新映射失败时整体读入内存，替换失败时重新映射原存档
+    // 参数1：存档路径
+    // 参数2：替换文件的操作，返回是否成功
+    // 参数3：新存档包含的修改序号，替换成功后只保留之后的修改
+    // 返回：是否替换成功，失败时保留全部修改
+    bool replaceArchive(const QString& path, const std::function<bool()>& replace, quint64 savedSerial);
+
+    // 自上次clearChangedMonths()以来修改过的月份（取每月1日），增量快照只重新编码这些月份
+    const QSet<QDate>& changedMonths() const {return m_changedMonths;}
+
+    // 自上次clearChangedMonths()以来数据是否被整体替换过，替换后需要完整重建快照
+    bool monthsReplaced() const {return m_monthsReplaced;}
+
+    // 清空修改过的月份记录，创建快照后调用
+    void clearChangedMonths();
+
+    // 是否有尚未写入存档的数据
+    bool hasUnsavedChanges() const {return !m_dirty.isEmpty() || (m_archivePath.isEmpty() && !m_cache.isEmpty());}
+
+    // 检查是否包含指定日期
+    bool contains(const QDate& date) const;
+
+    // 获取指定日期的单日记录（按需解码），不存在时返回空记录
+    DayRecord record(const QDate& date) const;
+
+    // 获取指定日期的学习数据（旧结构，按需解码后转换）
+    DateStudyData value(const QDate& date) const {return record(date).toStudyData();}
+
+    // 获取指定日期单日记录的可写引用，不存在时创建，并标记为已修改
+    DayRecord& operator[](const QDate& date);
+
+    // 插入或覆盖指定日期的单日记录
+    void insert(const QDate& date, const DayRecord& record);
+
+    // 获取总天数
+    int size() const {return m_view.dayCount() + m_extraDays;}
+
+    // 获取最早有数据的日期，没有数据时返回无效日期
+    QDate firstDate() const;
+
+    // 获取最晚有数据的日期，没有数据时返回无效日期
+    QDate lastDate() const;
+
+    // 获取当前缓存中已解码的天数
+    int cachedDayCount() const {return m_cache.size();}
+
+    // 设置最多缓存多少个月份的未修改数据
+    void setMaxCachedMonths(int months){m_maxCachedMonths = qMax(1, months);}
+
+    // 统计日期区间内的天数、学习时长、完成数与总数
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    // 返回：区间统计结果
+    StudyColumns::Totals totals(const QDate& from = QDate(), const QDate& to = QDate()) const;
+
+    // 按日期顺序遍历全部日期的统计字段（学习时长、完成数、总数）
+    // 未解码的日期直接读取索引，传给访问者的记录不保证包含时段
+    // 参数1：访问者，形如 void(const QDate&, const DayRecord&)
+    template <typename Visitor>
+    void forEachSummary(Visitor visitor) const {forEachSummary(QDate(), QDate(), visitor);}
+
+    // 按日期顺序遍历区间内日期的统计字段
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    // 参数3：访问者，形如 void(const QDate&, const DayRecord&)
+    template <typename Visitor>
+    void forEachSummary(const QDate& from, const QDate& to, Visitor visitor) const;
+
+    // 按日期顺序遍历区间内日期的完整记录，只经过有数据的日期，不拷贝也不写入缓存
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    // 参数3：访问者，形如 void(const QDate&, const DayRecord&)，记录只在调用期间有效
+    template <typename Visitor>
+    void forEachInRange(const QDate& from, const QDate& to, Visitor visitor) const;
+
+    // 获取日期区间上的游标
+    // 参数1：起始日期（含），无效时不限
+    // 参数2：结束日期（含），无效时不限
+    Cursor range(const QDate& from, const QDate& to) const {return Cursor(*this, from, to);}
+
+private:
+    // 释放存档映射
+    void unmap();
+
+    // 映射并校验存档，成功后替换当前映射，只保留修改序号大于给定值的脏数据
+    // 返回：是否成功，失败时保持原有数据不变
+    bool mapArchive(const QString& path, quint64 keepAfterSerial, QString* errorString);
+
+    // 整体解码存档放入缓存，再叠加修改序号大于给定值的脏数据（无法映射时的退路）
+    // 返回：是否成功，失败时保持原有数据不变
+    bool loadArchive(const QString& path, quint64 keepAfterSerial, QString* errorString);
+
+    // 取出修改序号大于给定值的脏数据
+    void keptChanges(quint64 keepAfterSerial, QMap<QDate, DayRecord>& kept, QHash<QDate, quint64>& keptDirty) const;
+
+    // 解码指定日期进缓存
+    // 返回：缓存中的记录，不存在时返回nullptr
+    DayRecord* load(const QDate& date) const;
+
+    // 记录月份访问，超出上限时淘汰最久未访问月份中未修改的数据
+    void touchMonth(const QDate& date) const;
+
+    // 建立列式统计，或重建已失效的年份
+    void ensureColumns() const;
+
+    // 丢弃列式统计，下次统计时重建
+    void resetColumns();
+
+private:
+    QFile* m_file = nullptr;
+    uchar* m_mapped = nullptr;
+    QString m_archivePath; // 未解码的日期所在的存档，数据已全部在缓存中时为空
+    StudyCodec::View m_view;
+
+    mutable QMap<QDate, DayRecord> m_cache;
+    QHash<QDate, quint64> m_dirty; // 修改过的日期 -> 最后一次修改的序号
+    quint64 m_editSerial = 0;
+    int m_extraDays = 0; // 只存在于缓存、不在存档中的天数
+    QSet<QDate> m_changedMonths; // 上次快照之后修改过的月份
+    bool m_monthsReplaced = false;
+
+    mutable QList<int> m_monthLru;
+    int m_maxCachedMonths = 3;
+
+    mutable StudyColumns m_columns;
+    mutable bool m_columnsBuilt = false;
+    mutable QSet<int> m_staleYears;
+};
+
+template <typename Visitor>
+void StudyStore::forEachSummary(const QDate& from, const QDate& to, Visitor visitor) const
+{
+    for (Cursor cursor(*this, from, to); !cursor.atEnd(); cursor.next()) {
+        visitor(cursor.date(), cursor.summary());
+    }
+}
+
+template <typename Visitor>
+void StudyStore::forEachInRange(const QDate& from, const QDate& to, Visitor visitor) const
+{
+    for (Cursor cursor(*this, from, to); !cursor.atEnd(); cursor.next()) {
+        visitor(cursor.date(), cursor.record());
+    }
+}
+
+#endif // STUDYSTORE_H
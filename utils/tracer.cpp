@@ -0,0 +1,154 @@
+#include "tracer.h"
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+
+namespace {
+// 单个追踪事件
+struct TraceEvent
+{
+    const char* name;
+    char phase;      // 'X'：阶段，'i'：瞬时事件
+    qint64 startUs;
+    qint64 durationUs;
+    quint64 threadId;
+};
+
+// 追踪状态，在第一次使用时构造，不依赖全局对象的构造顺序
+struct TraceState
+{
+    QElapsedTimer clock;
+    QAtomicInt enabled{1};
+    QMutex mutex;
+    QVector<TraceEvent> events;
+
+    TraceState()
+    {
+        clock.start();
+        events.reserve(64);
+    }
+};
+
+TraceState& traceState()
+{
+    static TraceState state;
+    return state;
+}
+
+void appendEvent(const TraceEvent& event)
+{
+    TraceState& state = traceState();
+    QMutexLocker locker(&state.mutex);
+    if (state.enabled.loadRelaxed()) {
+        state.events.append(event);
+    }
+}
+}
+
+bool Tracer::isEnabled()
+{
+    return traceState().enabled.loadRelaxed() != 0;
+}
+
+void Tracer::disable()
+{
+    TraceState& state = traceState();
+    QMutexLocker locker(&state.mutex);
+    state.enabled.storeRelaxed(0);
+    state.events.clear();
+    state.events.squeeze();
+}
+
+qint64 Tracer::nowUs()
+{
+    return traceState().clock.nsecsElapsed() / 1000;
+}
+
+void Tracer::addComplete(const char* name, qint64 startUs, qint64 durationUs)
+{
+    appendEvent({name, 'X', startUs, durationUs, quint64(quintptr(QThread::currentThreadId()))});
+}
+
+void Tracer::addInstant(const char* name)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    appendEvent({name, 'i', nowUs(), 0, quint64(quintptr(QThread::currentThreadId()))});
+}
+
+// 写出trace-event格式的JSON，时间单位为微秒
+QString Tracer::writeToDirectory(const QString& directory)
+{
+    QJsonArray traceEvents;
+    {
+        TraceState& state = traceState();
+        QMutexLocker locker(&state.mutex);
+        const qint64 pid = QCoreApplication::applicationPid();
+        for (const TraceEvent& event : std::as_const(state.events)) {
+            QJsonObject obj;
+            obj.insert("name", QString::fromUtf8(event.name));
+            obj.insert("cat", "startup");
+            obj.insert("ph", QString(QLatin1Char(event.phase)));
+            obj.insert("ts", event.startUs);
+            if (event.phase == 'X') {
+                obj.insert("dur", event.durationUs);
+            } else {
+                obj.insert("s", "p");
+            }
+            obj.insert("pid", pid);
+            obj.insert("tid", qint64(event.threadId));
+            traceEvents.append(obj);
+        }
+    }
+
+    QJsonObject rootObj;
+    rootObj.insert("traceEvents", traceEvents);
+    rootObj.insert("displayTimeUnit", "ms");
+
+    QDir dir(directory);
+    const QString path = dir.filePath("trace_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".json");
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "无法打开追踪文件进行写入：" << path << "，错误：" << file.errorString();
+        return QString();
+    }
+    file.write(QJsonDocument(rootObj).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCritical() << "追踪文件写入失败：" << path << "，错误：" << file.errorString();
+        return QString();
+    }
+
+    // 只保留最近的若干个追踪文件
+    const QStringList traces = dir.entryList({"trace_*.json"}, QDir::Files, QDir::Name | QDir::Reversed);
+    for (int i = kTracesToKeep; i < traces.size(); ++i) {
+        dir.remove(traces[i]);
+    }
+    return path;
+}
+
+TraceScope::TraceScope(const char* name)
+    : m_name(name)
+{
+    if (Tracer::isEnabled()) {
+        m_startUs = Tracer::nowUs();
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if (m_startUs >= 0 && Tracer::isEnabled()) {
+        Tracer::addComplete(m_name, m_startUs, Tracer::nowUs() - m_startUs);
+    }
+}
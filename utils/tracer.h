@@ -0,0 +1,66 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+
+/**
+ * @brief The Tracer class
+ * 启动阶段的耗时追踪，输出为Chrome trace-event格式的JSON（可在chrome://tracing或Perfetto中打开）。
+ * 全局AppDatas在main()之前构造，无法先解析命令行，因此进程启动后先在内存中记录，
+ * 由main()根据--trace参数决定写出文件还是丢弃记录并停止追踪。未启用时每个阶段只多一次原子读取。
+ * 可在任意线程调用。
+ */
+class Tracer
+{
+public:
+    // 启用追踪的命令行参数
+    static constexpr const char* kCommandLineFlag = "--trace";
+
+    // 日志目录中保留的追踪文件数量
+    static const int kTracesToKeep = 10;
+
+    // 是否正在记录
+    static bool isEnabled();
+
+    // 停止记录并丢弃已记录的事件
+    static void disable();
+
+    // 记录一个已结束的阶段
+    // 参数1：阶段名称
+    // 参数2：开始时间，自第一次追踪起的微秒数
+    // 参数3：持续时间，微秒数
+    static void addComplete(const char* name, qint64 startUs, qint64 durationUs);
+
+    // 记录一个瞬时事件
+    // 参数1：事件名称
+    static void addInstant(const char* name);
+
+    // 获取自第一次追踪起的微秒数，第一次追踪发生在全局AppDatas构造时，接近进程启动
+    static qint64 nowUs();
+
+    // 把已记录的事件写入日志目录下的新追踪文件，并删除过旧的追踪文件
+    // 参数1：日志目录
+    // 返回：追踪文件路径，失败时返回空字符串
+    static QString writeToDirectory(const QString& directory);
+};
+
+/**
+ * @brief The TraceScope class
+ * 以作用域计时一个阶段，析构时记录。
+ */
+class TraceScope
+{
+public:
+    // 参数1：阶段名称，须为静态字符串
+    explicit TraceScope(const char* name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_startUs = -1;
+};
+
+#endif // TRACER_H
@@ -0,0 +1,294 @@
+#include "calendarheatmap.h"
+#include "./appdatas.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QHelpEvent>
+#include <QLinearGradient>
+#include <QToolTip>
+
+namespace {
+const char* const kWeekNames[7] = {"日", "一", "二", "三", "四", "五", "六"};
+
+// 周日为0的星期序号
+int weekColumn(const QDate& date)
+{
+    return date.dayOfWeek() % 7;
+}
+}
+
+CalendarHeatmap::CalendarHeatmap(Mode mode, QWidget *parent)
+    : QWidget{parent}
+    , m_mode(mode)
+{
+    if (m_mode == MonthMode) {
+        // 与原月历单元格尺寸一致
+        m_cellSize = 48;
+        m_gap = 4;
+        m_rows = 6;
+        m_columns = 7;
+        m_origin = QPoint(0, 24);
+    } else {
+        // 一年最多跨越54周
+        m_cellSize = 12;
+        m_gap = 3;
+        m_rows = 7;
+        m_columns = 54;
+        m_origin = QPoint(22, 18);
+    }
+    setMouseTracking(true);
+    setFixedSize(sizeHint());
+}
+
+// 显示指定月份（月模式）
+void CalendarHeatmap::setMonth(int year, int month)
+{
+    const QDate first(year, month, 1);
+    setRange(first, first.addDays(first.daysInMonth() - 1));
+}
+
+// 显示指定年份（年模式）
+void CalendarHeatmap::setYear(int year)
+{
+    setRange(QDate(year, 1, 1), QDate(year, 12, 31));
+}
+
+// 设置显示范围并重新读取
+void CalendarHeatmap::setRange(const QDate& from, const QDate& to)
+{
+    m_from = from;
+    m_to = to;
+    m_leadingCells = weekColumn(from);
+    reload();
+}
+
+// 重新读取显示范围内全部日期的统计并重绘
+// 统计字段直接取自存储索引，不解码时段
+void CalendarHeatmap::reload()
+{
+    m_targetMinutes = qMax(1, appDatas.targetHour()) * 60;
+    m_minutes.fill(0, m_from.isValid() ? m_from.daysTo(m_to) + 1 : 0);
+    if (!m_minutes.isEmpty()) {
+        appDatas.forEachSummary(m_from, m_to, [this](const QDate& date, const DayRecord& record) {
+            m_minutes[m_from.daysTo(date)] = record.studyMinutes;
+        });
+    }
+    update();
+}
+
+// 重新读取某一天的统计，只重绘该单元格
+void CalendarHeatmap::refreshDate(const QDate& date)
+{
+    const int index = cellIndexOf(date);
+    if (index < 0) {
+        return;
+    }
+    const quint16 minutes = appDatas.record(date).studyMinutes;
+    quint16& cached = m_minutes[m_from.daysTo(date)];
+    if (cached == minutes) {
+        return;
+    }
+    cached = minutes;
+    update(cellRect(index));
+}
+
+// 获取坐标处的日期，落在单元格间隙上时视为没有命中
+QDate CalendarHeatmap::dateAt(const QPoint& pos) const
+{
+    const int pitch = m_cellSize + m_gap;
+    const int x = pos.x() - m_origin.x();
+    const int y = pos.y() - m_origin.y();
+    if (x < 0 || y < 0 || x % pitch >= m_cellSize || y % pitch >= m_cellSize) {
+        return QDate();
+    }
+    const int column = x / pitch;
+    const int row = y / pitch;
+    if (column >= m_columns || row >= m_rows) {
+        return QDate();
+    }
+
+    const int index = m_mode == MonthMode ? row * m_columns + column : column * m_rows + row;
+    const int day = index - m_leadingCells;
+    if (day < 0 || day >= m_minutes.size()) {
+        return QDate();
+    }
+    return m_from.addDays(day);
+}
+
+QSize CalendarHeatmap::sizeHint() const
+{
+    const int pitch = m_cellSize + m_gap;
+    return QSize(m_origin.x() + m_columns * pitch - m_gap, m_origin.y() + m_rows * pitch - m_gap);
+}
+
+// 获取网格中第index个单元格的区域
+QRect CalendarHeatmap::cellRect(int index) const
+{
+    const int pitch = m_cellSize + m_gap;
+    const int column = m_mode == MonthMode ? index % m_columns : index / m_rows;
+    const int row = m_mode == MonthMode ? index / m_columns : index % m_rows;
+    return QRect(m_origin.x() + column * pitch, m_origin.y() + row * pitch, m_cellSize, m_cellSize);
+}
+
+// 获取日期对应的网格序号
+int CalendarHeatmap::cellIndexOf(const QDate& date) const
+{
+    if (!m_from.isValid() || date < m_from || date > m_to) {
+        return -1;
+    }
+    return m_leadingCells + int(m_from.daysTo(date));
+}
+
+// 只绘制与待重绘区域相交的单元格
+void CalendarHeatmap::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const QRect dirty = event->rect();
+
+    paintHeaders(painter, dirty);
+
+    for (int day = 0; day < m_minutes.size(); ++day) {
+        const QRect rect = cellRect(m_leadingCells + day);
+        if (!rect.intersects(dirty)) {
+            continue;
+        }
+        if (m_mode == MonthMode) {
+            paintMonthCell(painter, rect, m_from.addDays(day), m_minutes[day]);
+        } else {
+            paintYearCell(painter, rect, m_from.addDays(day), m_minutes[day]);
+        }
+    }
+}
+
+// 绘制星期与月份标题
+void CalendarHeatmap::paintHeaders(QPainter& painter, const QRect& dirty) const
+{
+    const int pitch = m_cellSize + m_gap;
+    QFont font = painter.font();
+
+    if (m_mode == MonthMode) {
+        if (dirty.top() >= m_origin.y()) {
+            return;
+        }
+        font.setPixelSize(12);
+        font.setBold(true);
+        painter.setFont(font);
+        painter.setPen(QColor("#2D8CF0"));
+        for (int column = 0; column < 7; ++column) {
+            painter.drawText(QRect(column * pitch, 0, m_cellSize, m_origin.y()), Qt::AlignCenter, kWeekNames[column]);
+        }
+        return;
+    }
+
+    font.setPixelSize(10);
+    painter.setFont(font);
+    painter.setPen(QColor("#909399"));
+
+    // 左侧只标注一、三、五
+    if (dirty.left() < m_origin.x()) {
+        for (int row = 1; row < 7; row += 2) {
+            painter.drawText(QRect(0, m_origin.y() + row * pitch, m_origin.x() - 4, m_cellSize), Qt::AlignRight | Qt::AlignVCenter, kWeekNames[row]);
+        }
+    }
+
+    // 月份标题对齐到该月1日所在的列
+    if (dirty.top() < m_origin.y() && m_from.isValid()) {
+        for (int month = 1; month <= 12; ++month) {
+            const QDate first(m_from.year(), month, 1);
+            const int column = cellIndexOf(first) / m_rows;
+            painter.drawText(QRect(m_origin.x() + column * pitch, 0, pitch * 4, m_origin.y()), Qt::AlignLeft | Qt::AlignVCenter, QString("%1月").arg(month));
+        }
+    }
+}
+
+// 月模式单元格，配色与原月历标签的样式表一致
+void CalendarHeatmap::paintMonthCell(QPainter& painter, const QRect& rect, const QDate& date, int minutes) const
+{
+    QFont font = painter.font();
+    font.setPixelSize(11);
+
+    if (minutes == 0) {
+        painter.setPen(QColor("#F0F0F0"));
+        painter.setBrush(QColor("#FFFFFF"));
+        painter.drawRoundedRect(QRectF(rect).adjusted(0.5, 0.5, -0.5, -0.5), 8, 8);
+        font.setBold(false);
+        painter.setPen(QColor("#909399"));
+    } else {
+        QLinearGradient gradient(rect.topLeft(), rect.topRight());
+        if (minutes >= m_targetMinutes) {
+            gradient.setColorAt(0, QColor("#27AE60"));
+            gradient.setColorAt(1, QColor("#219653"));
+        } else {
+            gradient.setColorAt(0, QColor("#2D8CF0"));
+            gradient.setColorAt(1, QColor("#1D7AD9"));
+        }
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(gradient);
+        painter.drawRoundedRect(rect, 8, 8);
+        font.setBold(true);
+        painter.setPen(Qt::white);
+    }
+
+    painter.setFont(font);
+    painter.drawText(rect, Qt::AlignCenter, QString("%1\n%2h").arg(date.day()).arg(DayRecord::formatHours(minutes)));
+}
+
+// 年模式单元格，颜色深浅随学习时长占目标的比例变化，达标为绿色
+void CalendarHeatmap::paintYearCell(QPainter& painter, const QRect& rect, const QDate& date, int minutes) const
+{
+    QColor color("#EBEDF0");
+    if (minutes >= m_targetMinutes) {
+        color = QColor("#27AE60");
+    } else if (minutes > 0) {
+        color = QColor("#2D8CF0");
+        color.setAlpha(80 + 175 * minutes / m_targetMinutes);
+    }
+
+    if (date == QDate::currentDate()) {
+        painter.setPen(QPen(QColor("#F39C12"), 1.5));
+    } else {
+        painter.setPen(Qt::NoPen);
+    }
+    painter.setBrush(color);
+    painter.drawRoundedRect(QRectF(rect).adjusted(0.5, 0.5, -0.5, -0.5), 2, 2);
+}
+
+void CalendarHeatmap::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        const QDate date = dateAt(event->position().toPoint());
+        if (date.isValid()) {
+            emit dateClicked(date);
+            return;
+        }
+    }
+    QWidget::mousePressEvent(event);
+}
+
+// 只在日期单元格上显示手型指针
+void CalendarHeatmap::mouseMoveEvent(QMouseEvent *event)
+{
+    const bool onDate = dateAt(event->position().toPoint()).isValid();
+    if (onDate != (cursor().shape() == Qt::PointingHandCursor)) {
+        setCursor(onDate ? Qt::PointingHandCursor : Qt::ArrowCursor);
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+// 年模式单元格较小，悬停时以提示显示日期与学习时长
+bool CalendarHeatmap::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip && m_mode == YearMode) {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+        const QDate date = dateAt(helpEvent->pos());
+        if (date.isValid()) {
+            QToolTip::showText(helpEvent->globalPos(), QString("%1：%2小时").arg(date.toString("yyyy-MM-dd"), DayRecord::formatHours(m_minutes[m_from.daysTo(date)])), this, cellRect(cellIndexOf(date)));
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
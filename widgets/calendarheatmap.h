@@ -0,0 +1,102 @@
+#ifndef CALENDARHEATMAP_H
+#define CALENDARHEATMAP_H
+
+#include <QWidget>
+#include <QDate>
+#include <QVector>
+
+/**
+ * @brief The CalendarHeatmap class
+ * 自绘的日历热力图，整月或整年的所有日期在一次paintEvent中绘制，不创建子控件。
+ * 月模式为7列6行的月历，年模式为按周分列、每列7天的热力图。
+ * 点击位置由单元格尺寸直接换算出日期；单日数据变化时只重绘该单元格。
+ */
+class CalendarHeatmap : public QWidget
+{
+    Q_OBJECT
+public:
+    // 显示模式
+    enum Mode {
+        MonthMode, // 单月
+        YearMode   // 整年
+    };
+
+    // 参数1：显示模式
+    // 参数2：父控件
+    explicit CalendarHeatmap(Mode mode, QWidget *parent = nullptr);
+
+    // 显示指定月份（月模式）
+    // 参数1：年
+    // 参数2：月
+    void setMonth(int year, int month);
+
+    // 显示指定年份（年模式）
+    // 参数1：年
+    void setYear(int year);
+
+    // 重新读取显示范围内全部日期的统计并重绘
+    void reload();
+
+    // 重新读取某一天的统计，只重绘该单元格，日期不在显示范围内时忽略
+    // 参数1：日期
+    void refreshDate(const QDate& date);
+
+    // 获取坐标处的日期
+    // 参数1：控件坐标
+    // 返回：日期，不在任何日期单元格上时返回无效日期
+    QDate dateAt(const QPoint& pos) const;
+
+    // 获取显示范围的第一天
+    QDate firstDate() const {return m_from;}
+
+    // 获取显示范围的最后一天
+    QDate lastDate() const {return m_to;}
+
+    QSize sizeHint() const override;
+
+signals:
+    // 点击了某一天
+    // 参数1：日期
+    void dateClicked(const QDate& date);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    bool event(QEvent *event) override;
+
+private:
+    // 设置显示范围并重新读取
+    void setRange(const QDate& from, const QDate& to);
+
+    // 获取网格中第index个单元格的区域
+    QRect cellRect(int index) const;
+
+    // 获取日期对应的网格序号，不在显示范围内时返回-1
+    int cellIndexOf(const QDate& date) const;
+
+    void paintHeaders(QPainter& painter, const QRect& dirty) const;
+    void paintMonthCell(QPainter& painter, const QRect& rect, const QDate& date, int minutes) const;
+    void paintYearCell(QPainter& painter, const QRect& rect, const QDate& date, int minutes) const;
+
+private:
+    Mode m_mode;
+
+    // 网格几何参数
+    int m_cellSize = 0;
+    int m_gap = 0;
+    int m_rows = 0;
+    int m_columns = 0;
+    QPoint m_origin;
+
+    // 显示范围与第一天之前的空白单元格数
+    QDate m_from;
+    QDate m_to;
+    int m_leadingCells = 0;
+
+    // 显示范围内每天的学习分钟数，按与第一天的间隔索引
+    QVector<quint16> m_minutes;
+    int m_targetMinutes = 60;
+};
+
+#endif // CALENDARHEATMAP_H
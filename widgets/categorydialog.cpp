@@ -0,0 +1,143 @@
+#include "categorydialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QColorDialog>
+#include <QMessageBox>
+#include "./appdatas.h"
+
+CategoryDialog::CategoryDialog(QWidget *parent)
+    : QDialog{parent}
+{
+    setWindowTitle("事项类型");
+    setObjectName("categoryDialog");
+    setModal(true);
+    resize(460, 420);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setSpacing(10);
+    layout->setContentsMargins(15, 15, 15, 15);
+
+    m_table = new QTableWidget(0, 4);
+    m_table->setHorizontalHeaderLabels({"名称", "颜色", "计入学习", "每日目标"});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    layout->addWidget(m_table);
+
+    m_categories = appDatas.categories().categories();
+    for (const CategoryTable::Category& category : std::as_const(m_categories)) {
+        appendRow(category);
+    }
+
+    // 新增类型
+    QHBoxLayout* addLayout = new QHBoxLayout;
+    m_nameEdit = new QLineEdit;
+    m_nameEdit->setPlaceholderText("新类型名称");
+    QPushButton* addBtn = new QPushButton("新增");
+    addLayout->addWidget(m_nameEdit);
+    addLayout->addWidget(addBtn);
+    layout->addLayout(addLayout);
+    connect(addBtn, &QPushButton::clicked, this, &CategoryDialog::addCategory);
+    connect(m_nameEdit, &QLineEdit::returnPressed, this, &CategoryDialog::addCategory);
+
+    QHBoxLayout* btnLayout = new QHBoxLayout;
+    QPushButton* okBtn = new QPushButton("保存");
+    QPushButton* cancelBtn = new QPushButton("取消");
+    okBtn->setObjectName("okBtn");
+    cancelBtn->setObjectName("cancelBtn");
+    btnLayout->addStretch();
+    btnLayout->addWidget(okBtn);
+    btnLayout->addWidget(cancelBtn);
+    layout->addLayout(btnLayout);
+    connect(okBtn, &QPushButton::clicked, this, [this]() {
+        apply();
+        accept();
+    });
+    connect(cancelBtn, &QPushButton::clicked, this, &CategoryDialog::reject);
+}
+
+// 在表格末尾添加一行，各列控件的修改直接写回m_categories
+void CategoryDialog::appendRow(const CategoryTable::Category& category)
+{
+    const int row = m_table->rowCount();
+    m_table->insertRow(row);
+    m_table->setItem(row, 0, new QTableWidgetItem(category.name));
+
+    QPushButton* colorBtn = new QPushButton(category.name);
+    colorBtn->setStyleSheet(QString("background-color:%1; color:%2; border:none; border-radius:4px;")
+                                .arg(category.background.name(), category.color.name()));
+    m_table->setCellWidget(row, 1, colorBtn);
+    connect(colorBtn, &QPushButton::clicked, this, [this, row]() {
+        pickColor(row);
+    });
+
+    QCheckBox* studyCb = new QCheckBox;
+    studyCb->setChecked(category.countsAsStudy);
+    m_table->setCellWidget(row, 2, studyCb);
+    connect(studyCb, &QCheckBox::toggled, this, [this, row](bool checked) {
+        m_categories[row].countsAsStudy = checked;
+    });
+
+    QSpinBox* targetSpin = new QSpinBox;
+    targetSpin->setRange(0, 24 * 60);
+    targetSpin->setSingleStep(DayRecord::kSlotMinutes);
+    targetSpin->setSuffix(" 分钟");
+    targetSpin->setSpecialValueText("不设目标");
+    targetSpin->setValue(category.targetMinutes);
+    m_table->setCellWidget(row, 3, targetSpin);
+    connect(targetSpin, &QSpinBox::valueChanged, this, [this, row](int minutes) {
+        m_categories[row].targetMinutes = minutes;
+    });
+}
+
+// 用名称输入框中的名称添加新类型
+void CategoryDialog::addCategory()
+{
+    const QString name = m_nameEdit->text().trimmed();
+    if (name.isEmpty()) {
+        return;
+    }
+    for (const CategoryTable::Category& category : std::as_const(m_categories)) {
+        if (category.name == name) {
+            QMessageBox::warning(this, "提示", QString("类型“%1”已存在").arg(name));
+            return;
+        }
+    }
+
+    // 新类型按将要分配的编号取默认配色
+    CategoryTable::Category category;
+    category.name = name;
+    category.color = QColor::fromHsv(m_categories.size() * 47 % 360, 200, 170);
+    category.background = CategoryTable::backgroundFor(category.color);
+    m_categories.append(category);
+    appendRow(category);
+    m_nameEdit->clear();
+}
+
+// 选择某一行的颜色，背景色随之生成
+void CategoryDialog::pickColor(int row)
+{
+    CategoryTable::Category& category = m_categories[row];
+    const QColor color = QColorDialog::getColor(category.color, this, QString("选择“%1”的颜色").arg(category.name));
+    if (!color.isValid()) {
+        return;
+    }
+    category.color = color;
+    category.background = CategoryTable::backgroundFor(color);
+    QPushButton* colorBtn = qobject_cast<QPushButton*>(m_table->cellWidget(row, 1));
+    if (colorBtn) {
+        colorBtn->setStyleSheet(QString("background-color:%1; color:%2; border:none; border-radius:4px;")
+                                    .arg(category.background.name(), category.color.name()));
+    }
+}
+
+// 一次提交全部修改，学习时长最多重新计算一次
+void CategoryDialog::apply()
+{
+    appDatas.updateCategories(m_categories);
+}
@@ -0,0 +1,44 @@
+#ifndef CATEGORYDIALOG_H
+#define CATEGORYDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QLineEdit>
+#include <QList>
+#include "./utils/dayrecord.h"
+
+/**
+ * @brief The CategoryDialog class
+ * 事项类型管理对话框，可新增类型，修改各类型的配色、是否计入学习时长与每日目标。
+ * 修改先保存在对话框中，点击保存后一次提交；已有类型不能改名或删除。
+ */
+class CategoryDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit CategoryDialog(QWidget *parent = nullptr);
+
+private:
+    // 在表格末尾添加一行
+    // 参数1：类型属性
+    void appendRow(const CategoryTable::Category& category);
+
+    // 用名称输入框中的名称添加新类型
+    void addCategory();
+
+    // 选择某一行的颜色
+    // 参数1：行号
+    void pickColor(int row);
+
+    // 提交全部修改
+    void apply();
+
+private:
+    QTableWidget* m_table = nullptr;
+    QLineEdit* m_nameEdit = nullptr;
+
+    // 各行的类型属性，下标与行号即类型编号，超出已有类型数的行为新增类型
+    QList<CategoryTable::Category> m_categories;
+};
+
+#endif // CATEGORYDIALOG_H
@@ -4,7 +4,12 @@
 #include "./appdatas.h"
 #include "./utils/datehelper.h"
 #include "./utils/widgetcontainer.h"
+#include "./utils/tracer.h"
 #include <QStyle>
+#include <QComboBox>
+#include <QDateEdit>
+#include <QCheckBox>
+#include <QInputDialog>
 
 DayView::DayView(QWidget *parent)
     : QWidget{parent}
@@ -20,12 +25,16 @@ DayView::DayView(QWidget *parent)
     QHBoxLayout* dateBtnLayout = new QHBoxLayout;
     QPushButton* dateSelectBtn = new QPushButton("日期选择");
     QPushButton* todayBtn = new QPushButton("今日");
+    QPushButton* saveTemplateBtn = new QPushButton("存为模板");
+    QPushButton* applyTemplateBtn = new QPushButton("套用模板");
     QPushButton* clearBtn = new QPushButton("清除当日");
     clearBtn->setObjectName("clearBtn");
 
     dateBtnLayout->addWidget(dateSelectBtn);
     dateBtnLayout->addWidget(todayBtn);
     dateBtnLayout->addStretch();
+    dateBtnLayout->addWidget(saveTemplateBtn);
+    dateBtnLayout->addWidget(applyTemplateBtn);
     dateBtnLayout->addWidget(clearBtn);
     pageLayout->addLayout(dateBtnLayout);
 
@@ -107,6 +116,14 @@ DayView::DayView(QWidget *parent)
     connect(todayBtn, &QPushButton::clicked, this, &DayView::setToTodayDate);
     connect(setTargetBtn, &QPushButton::clicked, this, &DayView::showSetTargetDialog);
     connect(clearBtn, &QPushButton::clicked, this, &DayView::clearCurrentData);
+    connect(saveTemplateBtn, &QPushButton::clicked, this, &DayView::saveAsTemplate);
+    connect(applyTemplateBtn, &QPushButton::clicked, this, &DayView::showApplyTemplateDialog);
+
+    // 订阅数据变化
+    connect(&appDatas, &AppDatas::dayChanged, this, &DayView::onDayChanged);
+    connect(&appDatas, &AppDatas::targetHourChanged, this, &DayView::onTargetHourChanged);
+    connect(&appDatas, &AppDatas::dataReset, this, &DayView::onDataReset);
+    connect(&appDatas, &AppDatas::rangeChanged, this, &DayView::onRangeChanged);
 }
 
 DayView::~DayView(){
@@ -115,24 +132,26 @@ DayView::~DayView(){
 
 void DayView::updateDayViewStats()
 {
-    DateStudyData data = appDatas[DateHelper::currentDate()];
+    TraceScope trace("DayView::updateDayViewStats");
+    DayRecord data = appDatas.record(DateHelper::currentDate());
+    // 连续天数与最长连续天数都由索引计算，不再逐天回溯
     int continuousDays = appDatas.calculateContinuousDays();
-    appDatas.setMaxContinDays(qMax(appDatas.maxContinDays(), continuousDays));
-    m_todayStudyHourLabel->setText(QString("今日学习：%1小时 / <font color='#27AE60'>目标%2小时</font>").arg(data.studyHours).arg(appDatas.targetHour()));
+    const QString studyHours = DayRecord::formatHours(data.studyMinutes);
+    m_todayStudyHourLabel->setText(QString("今日学习：%1小时 / <font color='#27AE60'>目标%2小时</font>").arg(studyHours).arg(appDatas.targetHour()));
     m_todayStudyHourLabel->setTextFormat(Qt::RichText);
-    if(data.studyHours >= appDatas.targetHour())
+    if(data.reachesTarget(appDatas.targetHour()))
     {
         m_dayProgressBar->setValue(appDatas.targetHour());
     }
     else
     {
-        m_dayProgressBar->setValue(data.studyHours);
+        m_dayProgressBar->setValue(data.studyMinutes / 60);
     }
 
     m_continuousDaysLabel->setText(QString("当前连续天数：%1").arg(continuousDays));
     m_maxContinuousDaysLabel->setText(QString("最长连续天数：%1").arg(appDatas.maxContinDays()));
-    m_completedProjectsLabel->setText(QString("已完成项目：%1/%2").arg(data.completedProjects).arg(data.totalProjects));
-    m_studyCheckLabel->setText(QString("学习打卡：%1/%2").arg(data.studyHours).arg(appDatas.targetHour()));
+    m_completedProjectsLabel->setText(QString("已完成项目：%1/%2").arg(int(data.completedProjects)).arg(int(data.totalProjects)));
+    m_studyCheckLabel->setText(QString("学习打卡：%1/%2").arg(studyHours).arg(appDatas.targetHour()));
 }
 
 void DayView::showDateSelectDialog()
@@ -159,7 +178,7 @@ void DayView::showDateSelectDialog()
         m_selectedDateLabel->setText(QString("当前日期：%1").arg(date.toString("yyyy年MM月dd日")));
         loadDateData(DateHelper::currentDate());
         updateDayViewStats();
-        qobject_cast<MonthView*>(widgetContainer("monthView"))->switchMonth(DateHelper::calcCaleMonthDiff(date));
+        syncMonthView(DateHelper::calcCaleMonthDiff(date));
         dialog->close();
     });
 
@@ -172,7 +191,18 @@ void DayView::setToTodayDate()
     m_selectedDateLabel->setText(QString("当前日期：%1").arg(DateHelper::currentDate().toString("yyyy年MM月dd日")));
     loadDateData(DateHelper::currentDate());
     updateDayViewStats();
-    qobject_cast<MonthView*>(widgetContainer("monthView"))->switchMonth(0);
+    syncMonthView(0);
+}
+
+// 月视图跟随到当前日期所在月份，月视图尚未创建时只调整月历日期
+void DayView::syncMonthView(int monthOffset)
+{
+    MonthView* monthView = qobject_cast<MonthView*>(widgetContainer("monthView"));
+    if (monthView) {
+        monthView->switchMonth(monthOffset);
+    } else {
+        DateHelper::addCaleMonth(monthOffset);
+    }
 }
 
 void DayView::showSetTargetDialog()
@@ -197,15 +227,8 @@ void DayView::showSetTargetDialog()
         layout->addWidget(hourBtn);
 
         connect(hourBtn, &QPushButton::clicked, [=](){
+                // 界面由targetHourChanged信号统一刷新
                 appDatas.setTargetHour(hour);
-                m_todayStudyHourLabel->setText(QString("今日学习：%1小时 / <font color='#27AE60'>目标%2小时</font>").arg(appDatas[DateHelper::currentDate()].studyHours).arg(appDatas.targetHour()));
-                m_todayStudyHourLabel->setTextFormat(Qt::RichText);
-                m_dayProgressBar->setRange(0,appDatas.targetHour());
-                if(appDatas[DateHelper::currentDate()].studyHours >= appDatas.targetHour())
-                    m_dayProgressBar->setValue(appDatas.targetHour());
-                else
-                    m_dayProgressBar->setValue(appDatas[DateHelper::currentDate()].studyHours);
-                m_dayProgressBar->update();
                 dialog->close();
             });
     }
@@ -225,44 +248,169 @@ void DayView::showSetTargetDialog()
 
 void DayView::clearCurrentData()
 {
-    appDatas[DateHelper::currentDate()] = DateStudyData();
-    QList<int> hours = {8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23};
-    for(int hour : hours)
-    {
-        QPushButton* btn = m_timeAxisWidget->operator[](hour);
+    // 时间轴、统计与月历由dayChanged信号刷新
+    appDatas.clearDateData(DateHelper::currentDate());
+    QMessageBox::information(this, "提示", "当日数据已清除！");
+}
 
-        btn->setText("未安排");
-        btn->setObjectName("unPlanned");
+// 把当前日期的时间轴存为模板，同名模板会被覆盖
+void DayView::saveAsTemplate()
+{
+    const DayRecord record = appDatas.record(DateHelper::currentDate());
+    if (record.totalProjects == 0) {
+        QMessageBox::information(this, "提示", "当日时间轴为空，无法存为模板！");
+        return;
+    }
+
+    bool ok = false;
+    const QString name = QInputDialog::getText(this, "存为模板", "模板名称：", QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || name.isEmpty()) {
+        return;
+    }
+    if (appDatas.templates().contains(name)
+        && QMessageBox::question(this, "提示", QString("模板“%1”已存在，是否覆盖？").arg(name)) != QMessageBox::Yes) {
+        return;
+    }
+    if (appDatas.templates().insert(name, record)) {
+        QMessageBox::information(this, "提示", QString("已存为模板“%1”！").arg(name));
+    } else {
+        QMessageBox::warning(this, "提示", "模板保存失败！");
     }
-    appDatas.saveDataToFile();
-    loadDateData(DateHelper::currentDate());
-    updateDayViewStats();
-    qobject_cast<MonthView*>(widgetContainer("monthView"))->switchMonth(0);
-    QMessageBox::information(this, "提示", "当日数据已清除！");
 }
 
-void DayView::loadDateData(const QDate& date)
+// 选择模板并套用到日期区间内勾选的星期
+void DayView::showApplyTemplateDialog()
 {
-    if (!appDatas.contains(date)) {
-        appDatas[date] = DateStudyData();
+    if (appDatas.templates().names().isEmpty()) {
+        QMessageBox::information(this, "提示", "还没有模板，请先将某天的时间轴存为模板！");
+        return;
     }
-    DateStudyData data = appDatas[date];
 
-    QList<int> hours = {8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23};
-    for(int hour : hours)
-    {
-        QPushButton* btn = m_timeAxisWidget->operator[](hour);
-        if(data.timeAxisData.contains(hour))
-        {
-            TimeAxisItem item = data.timeAxisData[hour];
-            btn->setText(item.type);
+    QDialog* dialog = new QDialog(this);
+    dialog->setObjectName("applyTemplateDialog");
+    dialog->setWindowTitle("套用模板");
+    dialog->setModal(true);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    QVBoxLayout* layout = new QVBoxLayout(dialog);
+    layout->setContentsMargins(15,15,15,15);
+    layout->setSpacing(8);
+
+    QGridLayout* formLayout = new QGridLayout;
+    QComboBox* templateCombo = new QComboBox;
+    templateCombo->addItems(appDatas.templates().names());
+    QPushButton* deleteBtn = new QPushButton("删除");
+    formLayout->addWidget(new QLabel("模板："), 0, 0);
+    formLayout->addWidget(templateCombo, 0, 1);
+    formLayout->addWidget(deleteBtn, 0, 2);
+
+    // 默认从当前日期起套用四周
+    QDateEdit* fromEdit = new QDateEdit(DateHelper::currentDate());
+    QDateEdit* toEdit = new QDateEdit(DateHelper::currentDate().addDays(27));
+    fromEdit->setCalendarPopup(true);
+    toEdit->setCalendarPopup(true);
+    formLayout->addWidget(new QLabel("开始日期："), 1, 0);
+    formLayout->addWidget(fromEdit, 1, 1, 1, 2);
+    formLayout->addWidget(new QLabel("结束日期："), 2, 0);
+    formLayout->addWidget(toEdit, 2, 1, 1, 2);
+    layout->addLayout(formLayout);
+
+    // 星期选择，第(星期几-1)个复选框对应掩码的同一位
+    QHBoxLayout* weekdayLayout = new QHBoxLayout;
+    QList<QCheckBox*> weekdayChecks;
+    const QStringList weekdayNames = {"一", "二", "三", "四", "五", "六", "日"};
+    for (const QString& name : weekdayNames) {
+        QCheckBox* check = new QCheckBox(name);
+        check->setChecked(true);
+        weekdayLayout->addWidget(check);
+        weekdayChecks.append(check);
+    }
+    layout->addLayout(weekdayLayout);
+
+    QHBoxLayout* btnLayout = new QHBoxLayout;
+    QPushButton* confirmBtn = new QPushButton("套用");
+    QPushButton* cancelBtn = new QPushButton("取消");
+    cancelBtn->setObjectName("cancelBtn");
+    btnLayout->addStretch();
+    btnLayout->addWidget(confirmBtn);
+    btnLayout->addWidget(cancelBtn);
+    layout->addLayout(btnLayout);
+
+    connect(cancelBtn, &QPushButton::clicked, dialog, &QDialog::close);
+    connect(deleteBtn, &QPushButton::clicked, [=](){
+        const QString name = templateCombo->currentText();
+        if (QMessageBox::question(dialog, "提示", QString("确定删除模板“%1”吗？").arg(name)) != QMessageBox::Yes) {
+            return;
         }
-        else
-        {
-            btn->setText("未安排");
+        appDatas.templates().remove(name);
+        templateCombo->removeItem(templateCombo->currentIndex());
+        if (templateCombo->count() == 0) {
+            dialog->close();
         }
-        btn->setStyle(QApplication::style());
-    }
+    });
+    connect(confirmBtn, &QPushButton::clicked, [=](){
+        const QDate from = fromEdit->date();
+        const QDate to = toEdit->date();
+        if (from > to) {
+            QMessageBox::warning(dialog, "提示", "开始日期不能晚于结束日期！");
+            return;
+        }
+        int weekdayMask = 0;
+        for (int i = 0; i < weekdayChecks.size(); ++i) {
+            if (weekdayChecks[i]->isChecked()) {
+                weekdayMask |= 1 << i;
+            }
+        }
+        if (QMessageBox::question(dialog, "提示", "套用后所选日期原有的时间轴将被覆盖，是否继续？") != QMessageBox::Yes) {
+            return;
+        }
+        // 界面由rangeChanged信号统一刷新
+        const int days = appDatas.applyTemplate(appDatas.templates().value(templateCombo->currentText()), from, to, weekdayMask);
+        if (days == 0) {
+            QMessageBox::warning(dialog, "提示", "模板为空或所选日期中没有勾选的星期，未套用！");
+            return;
+        }
+        QMessageBox::information(dialog, "提示", QString("模板已套用到%1天！").arg(days));
+        dialog->close();
+    });
+
+    dialog->exec();
+}
+
+void DayView::loadDateData(const QDate& date)
+{
+    TraceScope trace("DayView::loadDateData");
+    // 只查看不插入空记录，没有数据的日期不算作打卡
+    m_timeAxisWidget->setDate(date);
+}
+
+// 某一天的数据变化，任何日期都可能改变最长连续天数，统计均为对数时间，直接刷新
+void DayView::onDayChanged(const QDate& date)
+{
+    Q_UNUSED(date);
+    updateDayViewStats();
+}
+
+// 学习目标变化，刷新进度条与打卡统计
+void DayView::onTargetHourChanged(int targetHour)
+{
+    m_dayProgressBar->setRange(0, targetHour);
+    updateDayViewStats();
+}
+
+// 全部数据被替换，重新载入当前日期
+void DayView::onDataReset()
+{
+    loadDateData(DateHelper::currentDate());
+    updateDayViewStats();
+}
+
+// 日期区间被批量修改，刷新统计
+void DayView::onRangeChanged(const QDate& from, const QDate& to)
+{
+    Q_UNUSED(from);
+    Q_UNUSED(to);
+    updateDayViewStats();
 }
 
 void DayView::setProgress(int hour){
@@ -10,6 +10,7 @@
 #include <QScrollArea>
 #include <QCalendarWidget>
 #include <QMessageBox>
+#include <QDialog>
 #include "timeaxis.h"
 
 /**
@@ -39,6 +40,10 @@ private:
     TimeAxis *m_timeAxisWidget = nullptr;
     QProgressBar *m_dayProgressBar = nullptr;
 
+    // 月视图跟随到当前日期所在月份
+    // 参数1：月份偏移量
+    void syncMonthView(int monthOffset);
+
 
 //signals:
 private slots:
@@ -46,6 +51,24 @@ private slots:
     void setToTodayDate();
     void showSetTargetDialog();
     void clearCurrentData();
+
+    // 把当前日期的时间轴存为模板
+    void saveAsTemplate();
+
+    // 选择模板并套用到日期区间
+    void showApplyTemplateDialog();
+
+    // 某一天的数据变化，刷新统计
+    void onDayChanged(const QDate& date);
+
+    // 学习目标变化，刷新进度条与打卡统计
+    void onTargetHourChanged(int targetHour);
+
+    // 全部数据被替换，重新载入当前日期
+    void onDataReset();
+
+    // 日期区间被批量修改，刷新统计
+    void onRangeChanged(const QDate& from, const QDate& to);
 };
 
 #endif // DAYVIEW_H
@@ -3,6 +3,9 @@
 #include "./appdatas.h"
 #include "./utils/widgetcontainer.h"
 #include "dayview.h"
+#include "calendarheatmap.h"
+#include "./utils/tracer.h"
+#include <algorithm>
 
 MonthView::MonthView(QWidget *parent)
     : QWidget{parent}
@@ -19,7 +22,7 @@ MonthView::MonthView(QWidget *parent)
     QPushButton* nextMonthBtn = new QPushButton("下月 ▶");
     QPushButton* currentMonthBtn = new QPushButton("当月");
     QPushButton* statisticsBtn = new QPushButton("学习统计");
-    m_monthTitleLabel = new QLabel(QString("%1年%2月").arg(DateHelper::currentYear()).arg(DateHelper::currentMonth()));
+    m_monthTitleLabel = new QLabel(QString("%1年%2月").arg(DateHelper::caleYear()).arg(DateHelper::caleMonth()));
     m_monthTitleLabel->setObjectName("monthTitleLabel");
     m_monthTitleLabel->setAlignment(Qt::AlignCenter);
     
@@ -122,17 +125,13 @@ MonthView::MonthView(QWidget *parent)
         lineAxisY->setMin(0);
         lineAxisY->setMax(8);
         
-        // 获取最近30天的学习数据
-        QMap<QDate, DateStudyData> monthData = appDatas.getRecentStudyData(30);
-        QList<QDate> monthDates = monthData.keys();
-        std::sort(monthDates.begin(), monthDates.end());
-        
-        for (const QDate &date : monthDates) {
+        // 最近30天的学习时长，按日期顺序只经过有数据的日期，只读取统计字段
+        const QDate today = QDate::currentDate();
+        appDatas.forEachSummary(today.addDays(-29), today, [lineSeries](const QDate& date, const DayRecord& record) {
             QDateTime dateTime;
             dateTime.setDate(date);
-            int hours = monthData[date].studyHours;
-            lineSeries->append(dateTime.toMSecsSinceEpoch(), hours);
-        }
+            lineSeries->append(dateTime.toMSecsSinceEpoch(), record.studyMinutes / 60.0);
+        });
         
         lineChart->addSeries(lineSeries);
         lineChart->addAxis(lineAxisX, Qt::AlignBottom);
@@ -145,10 +144,64 @@ MonthView::MonthView(QWidget *parent)
         lineChartView->setMinimumHeight(200);
         lineChartLayout->addWidget(lineChartView);
 
+        // 最近12周各类型时间分布，直接读取按周汇总中的类型计数，不遍历历史
+        const int chartWeeks = 12;
+        QGroupBox *categoryChartGroup = new QGroupBox(QString("最近%1周时间分布").arg(chartWeeks));
+        QVBoxLayout *categoryChartLayout = new QVBoxLayout(categoryChartGroup);
+        categoryChartLayout->setContentsMargins(10, 10, 10, 10);
+
+        QChart *categoryChart = new QChart();
+        categoryChart->setTitle("各类型时长（小时）");
+        categoryChart->setAnimationOptions(QChart::SeriesAnimations);
+
+        QStackedBarSeries *categorySeries = new QStackedBarSeries();
+        const QDate firstWeek = StudyRollups::periodStart(StudyRollups::Week, today.addDays(-7 * (chartWeeks - 1)));
+        QStringList weekLabels;
+        QVector<qreal> weekHours(chartWeeks, 0);
+        for (int week = 0; week < chartWeeks; ++week) {
+            weekLabels.append(firstWeek.addDays(7 * week).toString("MM-dd"));
+        }
+
+        const StudyRollups& rollups = appDatas.rollups();
+        const QStringList categoryNames = CategoryTable::names();
+        for (int category = 0; category < categoryNames.size(); ++category) {
+            const QMap<QDate, int> minutes = rollups.categoryMinutes(StudyRollups::Week, quint8(category), firstWeek, today);
+            if (std::none_of(minutes.cbegin(), minutes.cend(), [](int value) {return value > 0;})) {
+                continue;
+            }
+            QBarSet *categorySet = new QBarSet(categoryNames[category]);
+            for (int week = 0; week < chartWeeks; ++week) {
+                const qreal hours = minutes.value(firstWeek.addDays(7 * week)) / 60.0;
+                categorySet->append(hours);
+                weekHours[week] += hours;
+            }
+            categorySeries->append(categorySet);
+        }
+
+        QBarCategoryAxis *categoryAxisX = new QBarCategoryAxis();
+        categoryAxisX->append(weekLabels);
+        categoryAxisX->setTitleText("周（周一）");
+
+        QValueAxis *categoryAxisY = new QValueAxis();
+        categoryAxisY->setTitleText("小时");
+        categoryAxisY->setRange(0, qMax<qreal>(1, *std::max_element(weekHours.cbegin(), weekHours.cend())));
+
+        categoryChart->addSeries(categorySeries);
+        categoryChart->addAxis(categoryAxisX, Qt::AlignBottom);
+        categoryChart->addAxis(categoryAxisY, Qt::AlignLeft);
+        categorySeries->attachAxis(categoryAxisX);
+        categorySeries->attachAxis(categoryAxisY);
+
+        QChartView *categoryChartView = new QChartView(categoryChart);
+        categoryChartView->setRenderHint(QPainter::Antialiasing);
+        categoryChartView->setMinimumHeight(260);
+        categoryChartLayout->addWidget(categoryChartView);
+
         statsLayout->addWidget(studyHoursGroup);
         statsLayout->addWidget(projectsGroup);
         statsLayout->addWidget(continuousGroup);
         statsLayout->addWidget(lineChartGroup);
+        statsLayout->addWidget(categoryChartGroup);
 
         // 关闭按钮
         QHBoxLayout *closeLayout = new QHBoxLayout;
@@ -172,18 +225,18 @@ MonthView::MonthView(QWidget *parent)
     // 日历主体
     QGroupBox* calendarGroup = new QGroupBox("📅 月度学习记录");
     calendarGroup->setObjectName("calendarGroup");
-    m_monthCalendarLayout = new QGridLayout(calendarGroup);
-    m_monthCalendarLayout->setSpacing(4);  // 日历单元格间距极致紧凑
-    
-    // 星期标题
-    QStringList weeks = {"日", "一", "二", "三", "四", "五", "六"};
-    for (int i = 0; i < 7; ++i) {
-        QLabel* weekLab = new QLabel(weeks[i]);
-        weekLab->setStyleSheet("font-size:12px; font-weight:bold; color:#2D8CF0; text-align:center;");
-        weekLab->setAlignment(Qt::AlignCenter);
-        m_monthCalendarLayout->addWidget(weekLab, 0, i, Qt::AlignCenter);
-    }
-    calendarGroup->setLayout(m_monthCalendarLayout);
+    QVBoxLayout* calendarLayout = new QVBoxLayout(calendarGroup);
+
+    // 整月在一个控件中绘制，星期标题也由其绘制
+    m_calendar = new CalendarHeatmap(CalendarHeatmap::MonthMode);
+    calendarLayout->addWidget(m_calendar, 0, Qt::AlignCenter);
+    connect(m_calendar, &CalendarHeatmap::dateClicked, this, &MonthView::openDate);
+
+    // 订阅数据变化，不在当前月份的日期由日历自行忽略
+    connect(&appDatas, &AppDatas::dayChanged, this, &MonthView::refreshDate);
+    connect(&appDatas, &AppDatas::targetHourChanged, this, &MonthView::onTargetHourChanged);
+    connect(&appDatas, &AppDatas::dataReset, this, &MonthView::generateMonthCalendar);
+    connect(&appDatas, &AppDatas::rangeChanged, this, &MonthView::refreshRange);
     pageLayout->addWidget(calendarGroup);
 
     // 连接信号槽
@@ -204,66 +257,23 @@ void MonthView::switchMonth(int offset)
 // 生成月历
 void MonthView::generateMonthCalendar()
 {
-    const int year = DateHelper::caleYear(), month = DateHelper::caleMonth();
-    
-    // 清空现有日历项
-    QLayoutItem* item;
-    while ((item = m_monthCalendarLayout->takeAt(0)) != nullptr) {
-        delete item->widget();
-        delete item;
-    }
-    
-    // 清空日期标签映射
-    m_dateLabelMap.clear();
-
-    // 重新添加星期标题
-    QStringList weeks = {"日", "一", "二", "三", "四", "五", "六"};
-    for (int i = 0; i < 7; ++i) {
-        QLabel* weekLab = new QLabel(weeks[i]);
-        weekLab->setStyleSheet("font-size:12px;font-weight:bold;color:#2D8CF0;text-align:center;");
-        weekLab->setAlignment(Qt::AlignCenter);
-        m_monthCalendarLayout->addWidget(weekLab, 0, i, Qt::AlignCenter);
-    }
-
-    // 获取当月第一天和起始星期
-    QDate firstDay(year, month, 1);
-    int startWeek = firstDay.dayOfWeek();
-    startWeek = (startWeek == 7) ? 0 : startWeek;
-
-    int daysInMonth = firstDay.daysInMonth();
-    int row = 1;
-    int col = startWeek;
-
-    // 生成日期标签
-    for (int day = 1; day <= daysInMonth; ++day) {
-        QDate currentDate(year, month, day);
-        DateStudyData data = appDatas.value(currentDate);
-
-        QLabel* dayLabel = new QLabel(QString("%1\n%2h").arg(day).arg(data.studyHours));
-        dayLabel->setAlignment(Qt::AlignCenter);
-        dayLabel->setFixedSize(48, 48);  // 日历单元格尺寸紧凑压缩
-        dayLabel->setCursor(Qt::PointingHandCursor); // 设置鼠标指针为手型
-        
-        // 根据学习时长设置不同的背景色
-        if (data.studyHours == 0) {
-            dayLabel->setStyleSheet("background-color:#FFFFFF;border:1px solid #F0F0F0;border-radius:8px;font-size:11px;color:#909399;");
-        } else if (data.studyHours >= appDatas.targetHour()) {
-            dayLabel->setStyleSheet("background-color:qlineargradient(x1:0,y1:0,x2:1,y2:0,stop:0 #27AE60,stop:1 #219653);color:white;border-radius:8px;font-size:11px;font-weight:bold;");
-        } else {
-            dayLabel->setStyleSheet("background-color:qlineargradient(x1:0,y1:0,x2:1,y2:0,stop:0 #2D8CF0,stop:1 #1D7AD9);color:white;border-radius:8px;font-size:11px;font-weight:bold;");
-        }
+    TraceScope trace("MonthView::generateMonthCalendar");
+    m_calendar->setMonth(DateHelper::caleYear(), DateHelper::caleMonth());
+}
 
-        // 为日期标签安装事件过滤器
-        dayLabel->installEventFilter(this);
-        // 存储日期和标签的映射关系
-        m_dateLabelMap[dayLabel] = currentDate;
+// 只刷新某一天的单元格
+void MonthView::refreshDate(const QDate& date)
+{
+    m_calendar->refreshDate(date);
+}
 
-        m_monthCalendarLayout->addWidget(dayLabel, row, col, Qt::AlignCenter);
-        col++;
-        if (col >= 7) {
-            col = 0;
-            row++;
-        }
+// 日期区间批量修改，与当前显示的月份有交集时整月重新读取
+void MonthView::refreshRange(const QDate& from, const QDate& to)
+{
+    const QDate monthFirst(DateHelper::caleYear(), DateHelper::caleMonth(), 1);
+    const QDate monthLast = monthFirst.addMonths(1).addDays(-1);
+    if (from <= monthLast && to >= monthFirst) {
+        m_calendar->reload();
     }
 }
 
@@ -275,40 +285,29 @@ void MonthView::setToCurrentMonth()
     generateMonthCalendar();
 }
 
-// 事件过滤器，用于处理日期标签的点击事件
-// @param watched 被监视的对象
-// @param event 事件对象
-// @return 是否处理了该事件
-bool MonthView::eventFilter(QObject *watched, QEvent *event)
+// 学习目标变化，达标配色需要重新计算
+void MonthView::onTargetHourChanged()
 {
-    // 检查事件类型是否为鼠标按下事件
-    if (event->type() == QEvent::MouseButtonPress) {
-        // 检查被点击的对象是否是QLabel，并且在我们的日期标签映射中
-        QLabel *label = qobject_cast<QLabel*>(watched);
-        if (label && m_dateLabelMap.contains(label)) {
-            // 获取对应的日期
-            QDate clickedDate = m_dateLabelMap[label];
-            
-            // 设置当前日期
-            DateHelper::setCurrentDate(clickedDate);
-            
-            // 直接调用widgetContainer获取主窗口对象，通过QMetaObject::invokeMethod调用switchToDayView
-            QObject *mainWindow = widgetContainer("main");
-            if (mainWindow) {
-                QMetaObject::invokeMethod(mainWindow, "switchToDayView");
-            }
-            
-            // 更新日视图数据
-            DayView *dayView = qobject_cast<DayView*>(widgetContainer("dayView"));
-            if (dayView) {
-                dayView->loadDateData(clickedDate);
-                dayView->updateDayViewStats();
-            }
-            
-            return true; // 事件已处理
-        }
+    m_calendar->reload();
+}
+
+// 打开指定日期的日视图
+// @param date 被点击的日期
+void MonthView::openDate(const QDate& date)
+{
+    // 设置当前日期
+    DateHelper::setCurrentDate(date);
+    
+    // 直接调用widgetContainer获取主窗口对象，通过QMetaObject::invokeMethod调用switchToDayView
+    QObject *mainWindow = widgetContainer("main");
+    if (mainWindow) {
+        QMetaObject::invokeMethod(mainWindow, "switchToDayView");
     }
     
-    // 否则，继续传递事件
-    return QWidget::eventFilter(watched, event);
+    // 更新日视图数据
+    DayView *dayView = qobject_cast<DayView*>(widgetContainer("dayView"));
+    if (dayView) {
+        dayView->loadDateData(date);
+        dayView->updateDayViewStats();
+    }
 }
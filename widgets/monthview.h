@@ -14,9 +14,13 @@
 #include <QLineSeries>
 #include <QDateTimeAxis>
 #include <QValueAxis>
+#include <QStackedBarSeries>
+#include <QBarSet>
+#include <QBarCategoryAxis>
 
 // 前向声明
 class MainWindow;
+class CalendarHeatmap;
 
 /**
  * @brief The MonthView class
@@ -30,16 +34,29 @@ public:
     void switchMonth(int offset);
     void generateMonthCalendar();
     void setToCurrentMonth();
-    
-    // 事件过滤器，用于处理日期标签的点击事件
-    bool eventFilter(QObject *watched, QEvent *event) override;
+
+    // 只刷新某一天的单元格，日期不在当前显示的月份时忽略
+    // 参数1：日期
+    void refreshDate(const QDate& date);
+
+    // 日期区间批量修改，与当前显示的月份有交集时整月重新读取
+    // 参数1：起始日期（含）
+    // 参数2：结束日期（含）
+    void refreshRange(const QDate& from, const QDate& to);
+
+private:
+    // 打开指定日期的日视图
+    // 参数1：日期
+    void openDate(const QDate& date);
+
+    // 学习目标变化，达标配色需要重新计算
+    void onTargetHourChanged();
 
 private:
-    QGridLayout *m_monthCalendarLayout = nullptr;
     QLabel* m_monthTitleLabel = nullptr;
     
-    // 存储日期标签和对应日期的映射关系
-    QMap<QLabel*, QDate> m_dateLabelMap;
+    // 整月日历，自绘不含子控件
+    CalendarHeatmap* m_calendar = nullptr;
 
 signals:
 };
@@ -0,0 +1,130 @@
+#include "slotpicker.h"
+#include "./utils/dayrecord.h"
+#include "./appdatas.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QScreen>
+#include <QGuiApplication>
+
+SlotPicker::SlotPicker(QWidget *parent)
+    : QDialog{parent}
+{
+    // 点击弹窗外部时自动关闭，不阻塞事件循环
+    setWindowFlags(Qt::Popup);
+    setObjectName("timeAxisBtnDialog");
+    setAttribute(Qt::WA_StyledBackground);
+    setFixedWidth(240);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(15,15,15,15);
+    layout->setSpacing(8);
+
+    m_titleLabel = new QLabel("请选择事项类型");
+    layout->addWidget(m_titleLabel);
+
+    m_typesLayout = new QVBoxLayout;
+    m_typesLayout->setContentsMargins(0, 0, 0, 0);
+    m_typesLayout->setSpacing(8);
+    layout->addLayout(m_typesLayout);
+    reloadTypes();
+    connect(&appDatas, &AppDatas::categoriesChanged, this, &SlotPicker::reloadTypes);
+
+    QHBoxLayout* btnGroupLayout = new QHBoxLayout;
+    btnGroupLayout->setSpacing(8);
+    QPushButton* clearBtn = new QPushButton("清除");
+    QPushButton* cancelBtn = new QPushButton("取消");
+    clearBtn->setObjectName("clearBtn");
+    cancelBtn->setObjectName("cancelBtn");
+    clearBtn->setToolTip("快捷键：0");
+    cancelBtn->setToolTip("快捷键：Esc");
+    clearBtn->setFocusPolicy(Qt::NoFocus);
+    cancelBtn->setFocusPolicy(Qt::NoFocus);
+
+    btnGroupLayout->addStretch();
+    btnGroupLayout->addWidget(clearBtn);
+    btnGroupLayout->addWidget(cancelBtn);
+    btnGroupLayout->addStretch();
+    layout->addLayout(btnGroupLayout);
+
+    connect(clearBtn, &QPushButton::clicked, this, [=](){
+        close();
+        emit clearRequested(m_row);
+    });
+    connect(cancelBtn, &QPushButton::clicked, this, &SlotPicker::close);
+}
+
+// 为指定格子弹出，只更新标题与绑定的格子
+void SlotPicker::popup(int row, const QString& timeText, const QRect& anchor)
+{
+    m_row = row;
+    m_titleLabel->setText(QString("%1 请选择事项类型").arg(timeText));
+    adjustSize();
+
+    QPoint pos = anchor.bottomLeft();
+    const QScreen* screen = QGuiApplication::screenAt(anchor.center());
+    if (screen) {
+        const QRect available = screen->availableGeometry();
+        if (pos.y() + height() > available.bottom()) {
+            pos.setY(anchor.top() - height());
+        }
+        pos.setX(qBound(available.left(), pos.x(), available.right() - width()));
+    }
+    move(pos);
+    show();
+    activateWindow();
+}
+
+// 按类型字典重新生成事项按钮，快捷键放在提示中
+void SlotPicker::reloadTypes()
+{
+    while (QLayoutItem* item = m_typesLayout->takeAt(0)) {
+        delete item->widget();
+        delete item;
+    }
+
+    const int count = CategoryTable::count();
+    for (int id = 0; id < count; ++id) {
+        const CategoryTable::Category category = CategoryTable::info(quint8(id));
+        QPushButton* typeBtn = new QPushButton(category.name);
+        typeBtn->setStyleSheet(QString("QPushButton{font-size:12px; font-weight:bold; padding:6px 3px; border-radius:10px; border:none; background-color:%1; color:%2;}"
+                                       "QPushButton:hover{background-color:%3;}")
+                                   .arg(category.background.name(), category.color.name(), category.background.darker(104).name()));
+        if (id < 9) {
+            typeBtn->setToolTip(QString("快捷键：%1").arg(id + 1));
+        }
+        typeBtn->setFocusPolicy(Qt::NoFocus);
+        m_typesLayout->addWidget(typeBtn);
+
+        connect(typeBtn, &QPushButton::clicked, this, [=](){
+            close();
+            emit typePicked(m_row, quint8(id));
+        });
+    }
+}
+
+// 数字键对应的类型编号
+quint8 SlotPicker::categoryForKey(int key)
+{
+    const int id = key - Qt::Key_1;
+    if (id < 0 || id > 8 || id >= CategoryTable::count()) {
+        return CategoryTable::kInvalid;
+    }
+    return quint8(id);
+}
+
+void SlotPicker::keyPressEvent(QKeyEvent *event)
+{
+    const quint8 category = categoryForKey(event->key());
+    if (category != CategoryTable::kInvalid) {
+        close();
+        emit typePicked(m_row, category);
+        return;
+    }
+    if (event->key() == Qt::Key_0 || event->key() == Qt::Key_Delete || event->key() == Qt::Key_Backspace) {
+        close();
+        emit clearRequested(m_row);
+        return;
+    }
+    QDialog::keyPressEvent(event);
+}
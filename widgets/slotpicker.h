@@ -0,0 +1,56 @@
+#ifndef SLOTPICKER_H
+#define SLOTPICKER_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QPushButton>
+#include <QStringList>
+#include <QVBoxLayout>
+
+/**
+ * @brief The SlotPicker class
+ * 时间轴的事项选择弹窗。首次使用时创建一次，之后每次点击只更新标题与绑定的格子并移动位置。
+ * 事项按钮取自类型字典并使用各类型的配色，类型变化时重新生成。
+ * 弹窗内按数字键1~9直接选择编号对应的事项，按0或Delete清除，按Esc取消。
+ */
+class SlotPicker : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit SlotPicker(QWidget *parent = nullptr);
+
+    // 为指定格子弹出，位置紧贴在格子下方，超出屏幕时改为上方
+    // 参数1：格子序号，多选时为选中范围的第一格
+    // 参数2：格子或选中范围的时间文字
+    // 参数3：格子在屏幕上的区域
+    void popup(int row, const QString& timeText, const QRect& anchor);
+
+    // 数字键对应的类型编号，类型编号加一即快捷数字键
+    // 参数1：按键
+    // 返回：类型编号，不是对应的数字键时返回CategoryTable::kInvalid
+    static quint8 categoryForKey(int key);
+
+signals:
+    // 选择了事项
+    // 参数1：格子序号
+    // 参数2：类型编号
+    void typePicked(int row, quint8 category);
+
+    // 请求清除格子
+    // 参数1：格子序号
+    void clearRequested(int row);
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    // 按类型字典重新生成事项按钮
+    void reloadTypes();
+
+private:
+    QLabel* m_titleLabel = nullptr;
+    QVBoxLayout* m_typesLayout = nullptr;
+    int m_row = -1;
+};
+
+#endif // SLOTPICKER_H
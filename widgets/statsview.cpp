@@ -0,0 +1,157 @@
+#include "statsview.h"
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <algorithm>
+#include "./appdatas.h"
+#include "./utils/widgetcontainer.h"
+#include "./utils/tracer.h"
+
+StatsView::StatsView(QWidget *parent)
+    : QWidget{parent}
+{
+    widgetContainer("statsView", this);
+    this->setObjectName("statsView");
+    QVBoxLayout* pageLayout = new QVBoxLayout(this);
+    pageLayout->setContentsMargins(0, 0, 0, 0);
+    pageLayout->setSpacing(10);
+
+    // 粒度切换按钮
+    QHBoxLayout* periodLayout = new QHBoxLayout;
+    periodLayout->setSpacing(6);
+    const QStringList periodNames = {"按周", "按月", "按年"};
+    for (int period = 0; period < StudyRollups::PeriodCount; ++period) {
+        QPushButton* button = new QPushButton(periodNames[period]);
+        button->setCheckable(true);
+        connect(button, &QPushButton::clicked, this, [this, period]() {
+            setPeriod(StudyRollups::Period(period));
+        });
+        periodLayout->addWidget(button);
+        m_periodBtns[period] = button;
+    }
+    periodLayout->addStretch();
+    pageLayout->addLayout(periodLayout);
+
+    // 全部周期的合计
+    m_summaryLabel = new QLabel;
+    m_summaryLabel->setObjectName("monthTitleLabel");
+    m_summaryLabel->setAlignment(Qt::AlignCenter);
+    pageLayout->addWidget(m_summaryLabel);
+
+    // 每个周期一行
+    m_table = new QTableWidget(0, 5);
+    m_table->setHorizontalHeaderLabels({"周期", "学习时长", "完成项目", "达标率", "各类型时长"});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    pageLayout->addWidget(m_table);
+
+    m_periodBtns[m_period]->setChecked(true);
+
+    // 单日修改只改动汇总中的一项，但表格很小，整体重新读取即可
+    connect(&appDatas, &AppDatas::dayChanged, this, &StatsView::onDataChanged);
+    connect(&appDatas, &AppDatas::rangeChanged, this, &StatsView::onDataChanged);
+    connect(&appDatas, &AppDatas::dataReset, this, &StatsView::onDataChanged);
+    connect(&appDatas, &AppDatas::targetHourChanged, this, &StatsView::onDataChanged);
+    connect(&appDatas, &AppDatas::categoriesChanged, this, &StatsView::onDataChanged);
+}
+
+// 按当前粒度重新读取汇总，最新的周期排在最上方
+void StatsView::reload()
+{
+    TraceScope trace("StatsView::reload");
+    m_stale = false;
+    const QMap<int, StudyRollups::Rollup>& rollups = appDatas.rollups().rollups(m_period);
+
+    int studyMinutes = 0;
+    int completedProjects = 0;
+    int totalProjects = 0;
+    int recordedDays = 0;
+    int targetDays = 0;
+
+    m_table->setRowCount(rollups.size());
+    int row = 0;
+    for (auto it = rollups.constEnd(); it != rollups.constBegin(); ++row) {
+        --it;
+        const StudyRollups::Rollup& rollup = it.value();
+
+        // 各类型按时长从多到少排列
+        QList<QPair<int, quint8>> categories;
+        for (int category = 0; category < rollup.categorySlots.size(); ++category) {
+            if (rollup.categorySlots[category] > 0) {
+                categories.append(qMakePair(rollup.categorySlots[category], quint8(category)));
+            }
+        }
+        std::sort(categories.begin(), categories.end(), [](const QPair<int, quint8>& a, const QPair<int, quint8>& b) {
+            return a.first > b.first;
+        });
+        QStringList categoryTexts;
+        for (const QPair<int, quint8>& category : std::as_const(categories)) {
+            const CategoryTable::Category info = CategoryTable::info(category.second);
+            QString text = QString("%1 %2h").arg(info.name, DayRecord::formatHours(category.first * DayRecord::kSlotMinutes));
+            // 设有每日目标的类型附上日均时长
+            if (info.targetMinutes > 0 && rollup.recordedDays > 0) {
+                text += QString("（日均%1h/目标%2h）")
+                            .arg(DayRecord::formatHours(category.first * DayRecord::kSlotMinutes / rollup.recordedDays))
+                            .arg(DayRecord::formatHours(info.targetMinutes));
+            }
+            categoryTexts.append(text);
+        }
+
+        m_table->setItem(row, 0, new QTableWidgetItem(StudyRollups::periodLabel(m_period, rollup.start)));
+        m_table->setItem(row, 1, new QTableWidgetItem(QString("%1h").arg(DayRecord::formatHours(rollup.studyMinutes))));
+        m_table->setItem(row, 2, new QTableWidgetItem(QString("%1/%2").arg(rollup.completedProjects).arg(rollup.totalProjects)));
+        m_table->setItem(row, 3, new QTableWidgetItem(QString("%1% (%2/%3天)")
+                                                          .arg(qRound(rollup.targetHitRate() * 100))
+                                                          .arg(rollup.targetDays)
+                                                          .arg(rollup.recordedDays)));
+        m_table->setItem(row, 4, new QTableWidgetItem(categoryTexts.join("，")));
+
+        studyMinutes += rollup.studyMinutes;
+        completedProjects += rollup.completedProjects;
+        totalProjects += rollup.totalProjects;
+        recordedDays += rollup.recordedDays;
+        targetDays += rollup.targetDays;
+    }
+
+    m_summaryLabel->setText(QString("共%1个周期，记录%2天，学习%3小时，完成项目%4/%5，达标%6天")
+                                .arg(rollups.size())
+                                .arg(recordedDays)
+                                .arg(DayRecord::formatHours(studyMinutes))
+                                .arg(completedProjects)
+                                .arg(totalProjects)
+                                .arg(targetDays));
+}
+
+// 切换汇总粒度
+void StatsView::setPeriod(StudyRollups::Period period)
+{
+    for (int i = 0; i < StudyRollups::PeriodCount; ++i) {
+        m_periodBtns[i]->setChecked(i == period);
+    }
+    if (m_period == period) {
+        return;
+    }
+    m_period = period;
+    reload();
+}
+
+// 数据变化
+void StatsView::onDataChanged()
+{
+    if (isVisible()) {
+        reload();
+    } else {
+        m_stale = true;
+    }
+}
+
+// 显示时按需重新读取
+void StatsView::showEvent(QShowEvent *event)
+{
+    if (m_stale) {
+        reload();
+    }
+    QWidget::showEvent(event);
+}
@@ -0,0 +1,48 @@
+#ifndef STATSVIEW_H
+#define STATSVIEW_H
+
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include "./utils/studyrollups.h"
+
+/**
+ * @brief The StatsView class
+ * 统计仪表盘所对应的QWidget派生类。
+ * 按周、月、年列出学习时长、项目完成情况、达标率与各类型时长，最新的周期在最上方；
+ * 数据直接读取预先汇总，切换粒度不扫描历史。
+ */
+class StatsView : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit StatsView(QWidget *parent = nullptr);
+
+    // 按当前粒度重新读取汇总
+    void reload();
+
+private:
+    // 切换汇总粒度
+    // 参数1：粒度
+    void setPeriod(StudyRollups::Period period);
+
+    // 数据变化，可见时立即重新读取，否则等到下次显示
+    void onDataChanged();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    QPushButton* m_periodBtns[StudyRollups::PeriodCount] = {};
+    QLabel* m_summaryLabel = nullptr;
+    QTableWidget* m_table = nullptr;
+
+    StudyRollups::Period m_period = StudyRollups::Week;
+
+    // 是否需要在下次显示时重新读取
+    bool m_stale = true;
+};
+
+#endif // STATSVIEW_H
@@ -1,147 +1,416 @@
 #include "timeaxis.h"
-#include "dayview.h"
+#include "slotpicker.h"
 #include "./datastruct.h"
 #include "./appdatas.h"
-#include "./utils/datehelper.h"
 #include "./utils/widgetcontainer.h"
-#include "monthview.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QScrollArea>
+#include <QScrollBar>
+#include <QTimer>
+
+namespace {
+// 格子几何参数，与原先每小时一行的标签加按钮布局一致
+const int kMarginX = 3;
+const int kMarginY = 6;
+const int kLabelWidth = 50;
+const int kLabelSpacing = 5;
+const int kRowHeight = 30;
+const int kRowSpacing = 6;
+const int kRowPitch = kRowHeight + kRowSpacing;
+
+// 首次显示时滚动到的小时
+const int kMorningHour = 8;
+}
 
 TimeAxis::TimeAxis(QWidget *parent)
     : QWidget{parent}
 {
     this->setObjectName("timeAxis");
     widgetContainer("timeAxis",this);
-    QVBoxLayout* layout = new QVBoxLayout(this);
-    layout->setSpacing(6);   // 时间轴小时项间距紧凑
-    layout->setContentsMargins(3, 6, 3, 6);
+    setFocusPolicy(Qt::StrongFocus);
+    setMouseTracking(true);
+    setSlotMinutes(appDatas.slotMinutes());
 
-    QList<int> hours = {8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23};
-    for (int hour : hours) {
-        QHBoxLayout* hourLayout = new QHBoxLayout;
-        hourLayout->setSpacing(5);
+    // 数据与粒度变化时只重绘本控件
+    connect(&appDatas, &AppDatas::dayChanged, this, &TimeAxis::onDayChanged);
+    connect(&appDatas, &AppDatas::rangeChanged, this, [this](const QDate& from, const QDate& to) {
+        if (m_date >= from && m_date <= to) {
+            setDate(m_date);
+        }
+    });
+    connect(&appDatas, &AppDatas::slotMinutesChanged, this, &TimeAxis::setSlotMinutes);
+    // 类型配色变化只需重绘
+    connect(&appDatas, &AppDatas::categoriesChanged, this, [this]() {
+        update();
+    });
+}
 
-        QLabel* timeLabel = new QLabel(QString("%1:00").arg(hour));
-        timeLabel->setObjectName("timeLabel");
-        timeLabel->setMinimumWidth(45);
-        timeLabel->setFixedWidth(50);
-        timeLabel->setAlignment(Qt::AlignCenter);
+// 显示指定日期的时间轴，只拷贝一份定长记录
+void TimeAxis::setDate(const QDate& date)
+{
+    m_date = date;
+    m_record = appDatas.record(date);
+    update();
+}
 
-        QPushButton* axisBtn = new QPushButton("未安排");
-        axisBtn->setObjectName(QString::number(hour));
-        axisBtn->setEnabled(true);
-        axisBtn->setMinimumHeight(30);  // 时间轴按钮高度压缩
-        axisBtn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+// 设置一格的分钟数，格子数随之变化
+void TimeAxis::setSlotMinutes(int minutes)
+{
+    if (!AppDatas::isValidSlotMinutes(minutes)) {
+        return;
+    }
+    const int oldSlot = m_currentRow >= 0 ? m_currentRow * m_slotsPerRow : -1;
+    m_slotsPerRow = minutes / DayRecord::kSlotMinutes;
+    m_currentRow = oldSlot >= 0 ? oldSlot / m_slotsPerRow : -1;
+    m_anchorRow = -1;
+    m_hoverRow = -1;
+    setFixedHeight(sizeHint().height());
+    update();
+}
 
-        m_timeAxisBtnMap.insert(hour, axisBtn);
+// 获取某个时段所在格子的顶部坐标
+int TimeAxis::rowTop(int slot) const
+{
+    return kMarginY + slot / m_slotsPerRow * kRowPitch;
+}
 
-        hourLayout->addWidget(timeLabel);
-        hourLayout->addWidget(axisBtn);
-        hourLayout->setStretchFactor(axisBtn, 1);
+QSize TimeAxis::sizeHint() const
+{
+    return QSize(kMarginX * 2 + kLabelWidth + kLabelSpacing + 120, kMarginY * 2 + rowCount() * kRowPitch - kRowSpacing);
+}
 
-        layout->addLayout(hourLayout);
+// 某一天的数据变化，只处理当前显示的日期
+void TimeAxis::onDayChanged(const QDate& date)
+{
+    if (date == m_date) {
+        setDate(date);
+    }
+}
 
-        connect(axisBtn, &QPushButton::clicked, [=](){ onTimeAxisBtnClicked(hour); });
+// 获取坐标处的格子序号
+int TimeAxis::rowAt(const QPoint& pos) const
+{
+    const int y = pos.y() - kMarginY;
+    if (y < 0 || y % kRowPitch >= kRowHeight) {
+        return -1;
     }
+    const int row = y / kRowPitch;
+    return row < rowCount() ? row : -1;
 }
 
-void TimeAxis::onTimeAxisBtnClicked(int hour)
+// 获取格子的区域（含左侧时间标签）
+QRect TimeAxis::rowRect(int row) const
 {
-    QDialog* dialog = new QDialog(this);
-    dialog->setObjectName("timeAxisBtnDialog");
-    dialog->setWindowTitle("选择事项");
-    dialog->setModal(true);
-    dialog->resize(240, 260);
+    return QRect(kMarginX, kMarginY + row * kRowPitch, width() - kMarginX * 2, kRowHeight);
+}
 
-    QVBoxLayout* layout = new QVBoxLayout(dialog);
-    layout->setContentsMargins(15,15,15,15);
-    layout->setSpacing(8);
+// 获取选中范围的区域
+QRect TimeAxis::selectionRect() const
+{
+    if (m_currentRow < 0) {
+        return QRect();
+    }
+    return rowRect(selectionFirst()).united(rowRect(selectionLast()));
+}
 
-    QLabel* titleLabel = new QLabel("请选择事项类型");
-    layout->addWidget(titleLabel);
+// 获取格子显示的文字
+QString TimeAxis::rowText(int row) const
+{
+    QStringList names;
+    const int first = row * m_slotsPerRow;
+    for (int slot = first; slot < first + m_slotsPerRow; ++slot) {
+        const QString name = m_record.hasSlot(slot) ? CategoryTable::nameOf(m_record.categoryAt(slot)) : QString("未安排");
+        if (!names.contains(name)) {
+            names.append(name);
+        }
+    }
+    return names.join("/");
+}
 
-    QStringList types = {"学习", "吃饭", "睡觉", "洗澡", "游戏", "杂事"};
-    for (const QString& type : types) {
-        QPushButton* typeBtn = new QPushButton(type);
-        layout->addWidget(typeBtn);
+// 获取格内唯一的类型编号
+int TimeAxis::rowCategory(int row) const
+{
+    const int first = row * m_slotsPerRow;
+    const quint8 category = m_record.categoryAt(first);
+    for (int slot = first + 1; slot < first + m_slotsPerRow; ++slot) {
+        if (m_record.categoryAt(slot) != category) {
+            return -1;
+        }
+    }
+    return category;
+}
 
-        connect(typeBtn, &QPushButton::clicked, [=](){
-            confirmTimeAxisItem(hour, type);
-            dialog->close();
-        });
+// 获取事项类型的配色，取自类型字典
+void TimeAxis::typeColors(quint8 category, QColor& background, QColor& foreground)
+{
+    const CategoryTable::Category info = CategoryTable::info(category);
+    if (!info.name.isEmpty()) {
+        background = info.background;
+        foreground = info.color;
+    } else {
+        background = QColor("#FFFFFF");
+        foreground = QColor("#909399");
     }
+}
 
-    QHBoxLayout* btnGroupLayout = new QHBoxLayout;
-    btnGroupLayout->setSpacing(8);
-    QPushButton* clearBtn = new QPushButton("清除");
-    QPushButton* cancelBtn = new QPushButton("取消");
-    clearBtn->setObjectName("clearBtn");
-    cancelBtn->setObjectName("cancelBtn");
+// 只绘制与待重绘区域相交的格子，放在滚动区域中时即为露出的格子
+void TimeAxis::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const QRect dirty = event->rect();
 
-    btnGroupLayout->addStretch();
-    btnGroupLayout->addWidget(clearBtn);
-    btnGroupLayout->addWidget(cancelBtn);
-    btnGroupLayout->addStretch();
-    layout->addLayout(btnGroupLayout);
+    const int firstRow = qMax(0, (dirty.top() - kMarginY) / kRowPitch);
+    const int lastRow = qMin(rowCount() - 1, (dirty.bottom() - kMarginY) / kRowPitch);
 
-    connect(clearBtn, &QPushButton::clicked, this, [=](){
-        clearCurrentHourItem(hour);
-        dialog->close();
-    });
-    connect(cancelBtn, &QPushButton::clicked, dialog, &QDialog::close);
+    const bool multiSelected = selectionFirst() != selectionLast();
+    const bool showSelection = hasFocus() || m_dragging;
+
+    QFont font = painter.font();
+    font.setPixelSize(12);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const QRect rect = rowRect(row);
+        const QRect labelRect(rect.left(), rect.top(), kLabelWidth, rect.height());
+        const QRect buttonRect = rect.adjusted(kLabelWidth + kLabelSpacing, 0, 0, 0);
 
-    dialog->exec();
+        // 左侧时间标签
+        font.setBold(true);
+        painter.setFont(font);
+        painter.setPen(QColor("#2D8CF0"));
+        painter.drawText(labelRect, Qt::AlignCenter, DayRecord::slotLabel(row * m_slotsPerRow));
+
+        // 事项格子，格内只有一种类型时使用该类型的配色
+        const QString text = rowText(row);
+        const int category = rowCategory(row);
+        QColor background;
+        QColor foreground;
+        typeColors(category < 0 ? CategoryTable::kInvalid : quint8(category), background, foreground);
+        const bool selected = m_currentRow >= 0 && row >= selectionFirst() && row <= selectionLast();
+        if (selected && multiSelected) {
+            background = background.darker(110);
+        } else if (row == m_hoverRow) {
+            background = background.darker(104);
+        }
+        painter.setPen(selected && (showSelection || multiSelected) ? QPen(QColor("#2D8CF0"), 1.5) : QPen(Qt::NoPen));
+        painter.setBrush(background);
+        painter.drawRoundedRect(QRectF(buttonRect).adjusted(0.5, 0.5, -0.5, -0.5), 10, 10);
+
+        font.setBold(category != DayRecord::kEmptySlot);
+        painter.setFont(font);
+        painter.setPen(foreground);
+        painter.drawText(buttonRect, Qt::AlignCenter, text);
+    }
 }
 
-void TimeAxis::confirmTimeAxisItem(int hour, const QString& type)
+// 按下时选中一格，按住Shift时从当前格扩展到点击的格子，松开后再弹出选择弹窗
+void TimeAxis::mousePressEvent(QMouseEvent *event)
 {
-    bool isCompleted = true;
-    DateStudyData& data = appDatas[DateHelper::currentDate()];
+    if (event->button() == Qt::LeftButton) {
+        const int row = rowAt(event->position().toPoint());
+        if (row >= 0) {
+            const bool extend = (event->modifiers() & Qt::ShiftModifier) && m_currentRow >= 0;
+            setCurrentRow(row, extend);
+            if (!extend) {
+                m_anchorRow = row;
+            }
+            m_dragging = true;
+            return;
+        }
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void TimeAxis::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && m_dragging) {
+        m_dragging = false;
+        update(selectionRect());
+        openPicker();
+        return;
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+// 拖动时扩展选中范围；悬停的格子加深背景，只重绘前后两格
+void TimeAxis::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_dragging && (event->buttons() & Qt::LeftButton)) {
+        // 拖过格子间隙或超出上下边界时按最近的格子处理
+        const int y = event->position().toPoint().y() - kMarginY;
+        const int dragRow = qBound(0, y < 0 ? 0 : y / kRowPitch, rowCount() - 1);
+        if (dragRow != m_currentRow) {
+            setCurrentRow(dragRow, true);
+        }
+    }
+
+    const int row = rowAt(event->position().toPoint());
+    if (row != m_hoverRow) {
+        if (m_hoverRow >= 0) {
+            update(rowRect(m_hoverRow));
+        }
+        m_hoverRow = row;
+        if (m_hoverRow >= 0) {
+            update(rowRect(m_hoverRow));
+        }
+        setCursor(row >= 0 ? Qt::PointingHandCursor : Qt::ArrowCursor);
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void TimeAxis::leaveEvent(QEvent *event)
+{
+    if (m_hoverRow >= 0) {
+        update(rowRect(m_hoverRow));
+        m_hoverRow = -1;
+    }
+    QWidget::leaveEvent(event);
+}
 
-    if (data.timeAxisData.contains(hour))
-    {
-        TimeAxisItem oldItem = data.timeAxisData[hour];
-        if (oldItem.type == "学习" && oldItem.isCompleted) data.studyHours -= 1;
-        if (oldItem.isCompleted) data.completedProjects -= 1;
+// 快速安排按键作用于整个选中范围，尚未选中格子时从上午开始
+void TimeAxis::keyPressEvent(QKeyEvent *event)
+{
+    const int row = m_currentRow >= 0 ? m_currentRow : DayRecord::slotOf(kMorningHour) / m_slotsPerRow;
+    const bool extend = event->modifiers() & Qt::ShiftModifier;
+    const quint8 category = SlotPicker::categoryForKey(event->key());
+    if (category != CategoryTable::kInvalid) {
+        if (m_currentRow < 0) {
+            setCurrentRow(row);
+        }
+        const int last = selectionLast();
+        confirmTimeAxisItem(category);
+        setCurrentRow(last + 1 < rowCount() ? last + 1 : m_currentRow);
+        return;
+    }
+    switch (event->key()) {
+    case Qt::Key_0:
+    case Qt::Key_Delete:
+    case Qt::Key_Backspace: {
+        if (m_currentRow < 0) {
+            setCurrentRow(row);
+        }
+        const int last = selectionLast();
+        clearSelectedItems();
+        setCurrentRow(last + 1 < rowCount() ? last + 1 : m_currentRow);
+        return;
+    }
+    case Qt::Key_Down:
+        setCurrentRow(m_currentRow < 0 ? row : row + 1, extend && m_currentRow >= 0);
+        return;
+    case Qt::Key_Up:
+        setCurrentRow(row - 1, extend && m_currentRow >= 0);
+        return;
+    case Qt::Key_Escape:
+        if (selectionFirst() != selectionLast()) {
+            setCurrentRow(m_currentRow);
+            return;
+        }
+        break;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+    case Qt::Key_Space:
+        if (m_currentRow < 0) {
+            setCurrentRow(row);
+        }
+        openPicker();
+        return;
+    default:
+        break;
     }
+    QWidget::keyPressEvent(event);
+}
+
+// 焦点变化时重绘选中范围的边框
+void TimeAxis::focusInEvent(QFocusEvent *event)
+{
+    update(selectionRect());
+    QWidget::focusInEvent(event);
+}
 
-    data.timeAxisData[hour] = {type, isCompleted};
+void TimeAxis::focusOutEvent(QFocusEvent *event)
+{
+    update(selectionRect());
+    QWidget::focusOutEvent(event);
+}
 
-    if(m_timeAxisBtnMap.contains(hour)){
-        QPushButton* btn = m_timeAxisBtnMap[hour];
-        btn->setText(type);
-        btn->setStyle(QApplication::style());
+// 首次显示时滚动到上午，之前的时段仍可向上滚动查看
+void TimeAxis::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (m_scrolledToMorning) {
+        return;
     }
+    m_scrolledToMorning = true;
+    QTimer::singleShot(0, this, [this]() {
+        QScrollArea* scrollArea = qobject_cast<QScrollArea*>(parentWidget() ? parentWidget()->parentWidget() : nullptr);
+        if (scrollArea) {
+            scrollArea->verticalScrollBar()->setValue(rowTop(DayRecord::slotOf(kMorningHour)) - kMarginY);
+        }
+    });
+}
 
-    data.totalProjects = data.timeAxisData.count();
-    if (type == "学习" && isCompleted) data.studyHours += 1;
-    if (isCompleted) data.completedProjects += 1;
+// 为选中范围弹出事项选择弹窗，弹窗紧贴当前格
+void TimeAxis::openPicker()
+{
+    if (m_currentRow < 0) {
+        return;
+    }
+    if (!m_picker) {
+        m_picker = new SlotPicker(this);
+        connect(m_picker, &SlotPicker::typePicked, this, [this](int, quint8 category) {
+            confirmTimeAxisItem(category);
+        });
+        connect(m_picker, &SlotPicker::clearRequested, this, [this](int) {
+            clearSelectedItems();
+        });
+    }
 
-    appDatas.saveDataToFile();
-    qobject_cast<DayView*>(widgetContainer("dayView"))->updateDayViewStats();
-    qobject_cast<MonthView*>(widgetContainer("monthView"))->generateMonthCalendar();
+    const QRect rect = rowRect(m_currentRow);
+    const QString timeText = QString("%1 - %2").arg(DayRecord::slotLabel(selectionFirst() * m_slotsPerRow), DayRecord::slotLabel((selectionLast() + 1) * m_slotsPerRow));
+    m_picker->popup(selectionFirst(), timeText, QRect(mapToGlobal(rect.topLeft()), rect.size()));
 }
 
-void TimeAxis::clearCurrentHourItem(int hour)
+// 将焦点移到指定格子并滚动到可见，超出范围时保持不动
+void TimeAxis::setCurrentRow(int row, bool extend)
 {
-    DateStudyData& data = appDatas[DateHelper::currentDate()];
-    if (data.timeAxisData.contains(hour))
-    {
-        TimeAxisItem oldItem = data.timeAxisData[hour];
-        if (oldItem.type == "学习" && oldItem.isCompleted) data.studyHours -= 1;
-        if (oldItem.isCompleted) data.completedProjects -= 1;
-        data.timeAxisData.remove(hour);
-        data.totalProjects = data.timeAxisData.count();
+    if (row < 0 || row >= rowCount()) {
+        return;
+    }
+    update(selectionRect());
+    if (extend && m_anchorRow < 0) {
+        m_anchorRow = m_currentRow;
+    } else if (!extend) {
+        m_anchorRow = -1;
     }
+    m_currentRow = row;
+    update(selectionRect());
 
-    QPushButton* btn = m_timeAxisBtnMap[hour];
-    btn->setText("未安排");
-    btn->setStyle(QApplication::style());
+    QScrollArea* scrollArea = qobject_cast<QScrollArea*>(parentWidget() ? parentWidget()->parentWidget() : nullptr);
+    if (scrollArea) {
+        const QRect rect = rowRect(row);
+        scrollArea->ensureVisible(rect.center().x(), rect.center().y(), 0, kRowPitch);
+    }
+}
 
-    appDatas.saveDataToFile();
-    qobject_cast<DayView*>(widgetContainer("dayView"))->updateDayViewStats();
-    qobject_cast<MonthView*>(widgetContainer("monthView"))->generateMonthCalendar();
+// 安排选中的连续格子，整个范围只写一条日志，界面由一次dayChanged信号刷新
+void TimeAxis::confirmTimeAxisItem(quint8 category)
+{
+    if (m_currentRow < 0) {
+        return;
+    }
+    const int rows = selectionLast() - selectionFirst() + 1;
+    bool isCompleted = true;
+    appDatas.setTimeAxisItem(m_date, selectionFirst() * m_slotsPerRow, rows * m_slotsPerRow, category, isCompleted);
 }
 
-QPushButton* TimeAxis::operator[](int hour){
-    return m_timeAxisBtnMap[hour];
+// 清除选中的连续格子，同样只写一条日志
+void TimeAxis::clearSelectedItems()
+{
+    if (m_currentRow < 0) {
+        return;
+    }
+    const int rows = selectionLast() - selectionFirst() + 1;
+    appDatas.removeTimeAxisItem(m_date, selectionFirst() * m_slotsPerRow, rows * m_slotsPerRow);
 }
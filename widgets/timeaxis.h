@@ -2,34 +2,114 @@
 #define TIMEAXIS_H
 
 #include <QWidget>
-#include <QVBoxLayout>
-#include <QLabel>
-#include <QPushButton>
-#include <QDialog>
+#include <QDate>
+#include <QColor>
+#include "./utils/dayrecord.h"
+
+class SlotPicker;
 
 /**
  * @brief The TimeAxis class
- * DayView的时间轴子件。
+ * DayView的时间轴子件，覆盖全天0点至24点，一格为60、30或15分钟。
+ * 所有格子在一次paintEvent中自绘，不为每一格创建子控件；放在滚动区域中时只绘制露出的格子，
+ * 切换日期只拷贝一份定长的DayRecord，耗时与粒度无关。
+ * 点击格子弹出复用的事项选择弹窗；获得焦点时可直接按数字键快速安排当前格，
+ * 安排后焦点移到下一格，按0或Delete清除，上下方向键切换格子，回车弹出选择弹窗。
+ * 按住拖动、按住Shift点击或按Shift加上下方向键可选中连续多格，选中范围作为一次修改写入，
+ * 只产生一条日志记录与一次界面刷新。
  */
 class TimeAxis : public QWidget
 {
     Q_OBJECT
 public:
     explicit TimeAxis(QWidget *parent = nullptr);
-    QPushButton* operator[](int hour);
+
+    // 显示指定日期的时间轴
+    // 参数1：日期
+    void setDate(const QDate& date);
+
+    // 设置一格的分钟数
+    // 参数1：分钟数（60、30或15）
+    void setSlotMinutes(int minutes);
+
+    // 获取某个时段所在格子的顶部坐标
+    // 参数1：15分钟时段序号
+    int rowTop(int slot) const;
+
+    QSize sizeHint() const override;
 
 signals:
     void sendText(const QString& str);
 
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void focusInEvent(QFocusEvent *event) override;
+    void focusOutEvent(QFocusEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
 private:
-    QMap<int, QPushButton*> m_timeAxisBtnMap;
+    // 某一天的数据变化，只处理当前显示的日期
+    void onDayChanged(const QDate& date);
+
+    // 为选中范围弹出事项选择弹窗，弹窗只在第一次使用时创建
+    void openPicker();
+
+    // 安排或清除选中范围内的全部格子
+    void confirmTimeAxisItem(quint8 category);
+    void clearSelectedItems();
+
+    // 将焦点移到指定格子并滚动到可见
+    // 参数1：格子序号
+    // 参数2：是否从锚点格扩展选中范围，否则只选中该格
+    void setCurrentRow(int row, bool extend = false);
+
+    // 选中范围的首末格子序号，未选中时均为-1
+    int selectionFirst() const {return m_anchorRow < 0 ? m_currentRow : qMin(m_anchorRow, m_currentRow);}
+    int selectionLast() const {return m_anchorRow < 0 ? m_currentRow : qMax(m_anchorRow, m_currentRow);}
+
+    // 获取选中范围的区域
+    QRect selectionRect() const;
+
+    // 格子数
+    int rowCount() const {return DayRecord::kSlotCount / m_slotsPerRow;}
+
+    // 获取坐标处的格子序号，不在任何格子上时返回-1
+    int rowAt(const QPoint& pos) const;
+
+    // 获取格子的区域（含左侧时间标签）
+    QRect rowRect(int row) const;
+
+    // 获取格子显示的文字，格内各时段不一致时以“/”连接
+    QString rowText(int row) const;
+
+    // 获取格内唯一的类型编号，全部未安排时返回kEmptySlot
+    // 参数1：格子序号
+    // 返回：类型编号，格内各时段不一致时返回-1
+    int rowCategory(int row) const;
+
+    // 获取事项类型的配色，取自类型字典
+    // 参数1：类型编号，无效编号（未安排或多种类型）使用白底灰字
+    // 参数2：输出，背景色
+    // 参数3：输出，文字颜色
+    static void typeColors(quint8 category, QColor& background, QColor& foreground);
 
 private:
-    void onTimeAxisBtnClicked(int hour);
-    void confirmTimeAxisItem(int hour,const QString& type);
-    void clearCurrentHourItem(int hour);
+    QDate m_date;
+    DayRecord m_record;
+    int m_slotsPerRow = DayRecord::kSlotsPerHour;
+    int m_currentRow = -1;
+    int m_anchorRow = -1; // 多选时的起点格，-1表示只选中当前格
+    bool m_dragging = false;
+    int m_hoverRow = -1;
+    bool m_scrolledToMorning = false;
 
-signals:
+    // 事项选择弹窗，首次使用时创建，之后复用
+    SlotPicker* m_picker = nullptr;
 };
 
 #endif // TIMEAXIS_H
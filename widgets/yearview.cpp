@@ -0,0 +1,163 @@
+#include "yearview.h"
+#include "calendarheatmap.h"
+#include <QGroupBox>
+#include "dayview.h"
+#include "./appdatas.h"
+#include "./utils/datehelper.h"
+#include "./utils/widgetcontainer.h"
+#include "./utils/tracer.h"
+
+YearView::YearView(QWidget *parent)
+    : QWidget{parent}
+{
+    widgetContainer("yearView", this);
+    this->setObjectName("yearView");
+    QVBoxLayout* pageLayout = new QVBoxLayout(this);
+    pageLayout->setContentsMargins(0, 0, 0, 0);
+    pageLayout->setSpacing(10);
+
+    // 年份范围标题
+    m_rangeLabel = new QLabel;
+    m_rangeLabel->setObjectName("monthTitleLabel");
+    m_rangeLabel->setAlignment(Qt::AlignCenter);
+    pageLayout->addWidget(m_rangeLabel);
+
+    // 各年份纵向排列在滚动区域中
+    QScrollArea* scrollArea = new QScrollArea;
+    scrollArea->setWidgetResizable(true);
+    scrollArea->setFrameShape(QFrame::NoFrame);
+    QWidget* scrollContent = new QWidget;
+    m_yearsLayout = new QVBoxLayout(scrollContent);
+    m_yearsLayout->setContentsMargins(0, 0, 0, 0);
+    m_yearsLayout->setSpacing(10);
+    m_yearsLayout->addStretch();
+    scrollArea->setWidget(scrollContent);
+    pageLayout->addWidget(scrollArea);
+
+    // 订阅数据变化，尚未显示过的年份行不存在，单日变化直接忽略
+    connect(&appDatas, &AppDatas::dayChanged, this, &YearView::refreshDate);
+    connect(&appDatas, &AppDatas::targetHourChanged, this, &YearView::onBulkChanged);
+    connect(&appDatas, &AppDatas::dataReset, this, &YearView::onBulkChanged);
+    connect(&appDatas, &AppDatas::rangeChanged, this, &YearView::onBulkChanged);
+}
+
+// 按数据范围同步年份行，并重新读取全部年份
+// 年份范围不变时只重新读取，不增删控件
+void YearView::reload()
+{
+    TraceScope trace("YearView::reload");
+    m_stale = false;
+    const int currentYear = QDate::currentDate().year();
+    const QDate firstDate = appDatas.firstDate();
+    const QDate lastDate = appDatas.lastDate();
+    const int firstYear = firstDate.isValid() ? qMin(firstDate.year(), currentYear) : currentYear;
+    const int lastYear = lastDate.isValid() ? qMax(lastDate.year(), currentYear) : currentYear;
+
+    // 删除范围外的年份
+    for (auto it = m_rows.begin(); it != m_rows.end();) {
+        if (it.key() < firstYear || it.key() > lastYear) {
+            delete it.value().container;
+            it = m_rows.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // 补齐缺少的年份，最新的年份排在最上方
+    for (int year = lastYear; year >= firstYear; --year) {
+        if (!m_rows.contains(year)) {
+            const YearRow row = createRow(year);
+            m_yearsLayout->insertWidget(lastYear - year, row.container);
+            m_rows.insert(year, row);
+        }
+    }
+
+    for (auto it = m_rows.constBegin(); it != m_rows.constEnd(); ++it) {
+        it.value().heatmap->setYear(it.key());
+        updateSummary(it.key(), it.value());
+    }
+
+    m_rangeLabel->setText(firstYear == lastYear ? QString("%1年").arg(firstYear) : QString("%1年 - %2年").arg(firstYear).arg(lastYear));
+}
+
+// 只刷新某一天所在的单元格与年度汇总
+void YearView::refreshDate(const QDate& date)
+{
+    const auto it = m_rows.constFind(date.year());
+    if (m_stale) {
+        return;
+    }
+    if (it == m_rows.constEnd()) {
+        // 超出已显示年份范围，需要增加年份行
+        onBulkChanged();
+        return;
+    }
+    it.value().heatmap->refreshDate(date);
+    updateSummary(it.key(), it.value());
+}
+
+// 创建某一年的行
+YearView::YearRow YearView::createRow(int year)
+{
+    YearRow row;
+    row.container = new QGroupBox(QString("%1年").arg(year));
+    row.container->setObjectName("calendarGroup");
+    QVBoxLayout* rowLayout = new QVBoxLayout(row.container);
+    rowLayout->setSpacing(6);
+
+    row.summaryLabel = new QLabel;
+    row.summaryLabel->setStyleSheet("font-size:12px;color:#909399;");
+    rowLayout->addWidget(row.summaryLabel);
+
+    row.heatmap = new CalendarHeatmap(CalendarHeatmap::YearMode);
+    rowLayout->addWidget(row.heatmap, 0, Qt::AlignLeft);
+    connect(row.heatmap, &CalendarHeatmap::dateClicked, this, &YearView::openDate);
+    return row;
+}
+
+// 更新某一年的汇总文字，统计取自列式副本
+void YearView::updateSummary(int year, const YearRow& row)
+{
+    const StudyColumns::Totals totals = appDatas.totals(QDate(year, 1, 1), QDate(year, 12, 31));
+    row.summaryLabel->setText(QString("记录%1天，学习%2小时，完成项目%3/%4")
+                                  .arg(totals.days)
+                                  .arg(DayRecord::formatHours(totals.studyMinutes))
+                                  .arg(totals.completedProjects)
+                                  .arg(totals.totalProjects));
+}
+
+// 学习目标变化或数据整体替换
+void YearView::onBulkChanged()
+{
+    if (isVisible()) {
+        reload();
+    } else {
+        m_stale = true;
+    }
+}
+
+// 显示时按需重新读取
+void YearView::showEvent(QShowEvent *event)
+{
+    if (m_stale) {
+        reload();
+    }
+    QWidget::showEvent(event);
+}
+
+// 打开指定日期的日视图
+void YearView::openDate(const QDate& date)
+{
+    DateHelper::setCurrentDate(date);
+
+    QObject *mainWindow = widgetContainer("main");
+    if (mainWindow) {
+        QMetaObject::invokeMethod(mainWindow, "switchToDayView");
+    }
+
+    DayView *dayView = qobject_cast<DayView*>(widgetContainer("dayView"));
+    if (dayView) {
+        dayView->loadDateData(date);
+        dayView->updateDayViewStats();
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef YEARVIEW_H
+#define YEARVIEW_H
+
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QScrollArea>
+#include <QMap>
+#include <QDate>
+
+class CalendarHeatmap;
+
+/**
+ * @brief The YearView class
+ * 年视窗所对应的QWidget派生类。
+ * 从最早有数据的年份到今年，每年一行自绘热力图，最新的年份在最上方；
+ * 各年数据取自存储的统计字段，滚动时只重绘露出的单元格。
+ */
+class YearView : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit YearView(QWidget *parent = nullptr);
+
+    // 按数据范围同步年份行，并重新读取全部年份
+    void reload();
+
+    // 只刷新某一天所在的单元格与年度汇总
+    // 参数1：日期
+    void refreshDate(const QDate& date);
+
+private:
+    // 单年一行
+    struct YearRow
+    {
+        QWidget* container = nullptr;
+        QLabel* summaryLabel = nullptr;
+        CalendarHeatmap* heatmap = nullptr;
+    };
+
+    // 创建某一年的行
+    // 参数1：年
+    YearRow createRow(int year);
+
+    // 更新某一年的汇总文字
+    // 参数1：年
+    // 参数2：行
+    void updateSummary(int year, const YearRow& row);
+
+    // 打开指定日期的日视图
+    // 参数1：日期
+    void openDate(const QDate& date);
+
+    // 学习目标变化、数据整体替换或批量修改，可见时立即重新读取，否则等到下次显示
+    void onBulkChanged();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    QLabel* m_rangeLabel = nullptr;
+    QVBoxLayout* m_yearsLayout = nullptr;
+
+    // 按年份索引的行
+    QMap<int, YearRow> m_rows;
+
+    // 是否需要在下次显示时重新读取
+    bool m_stale = true;
+};
+
+#endif // YEARVIEW_H